@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rm/overlay.hpp"
+#include "nav/path.hpp"
+#include "nav/heap.hpp"
+#include "nav/navmap.hpp"
+
+/**
+ * @file gatemap.hpp
+ * @brief This file is dedicated to the GateMap class.
+ *
+ * @see nav#GateMap
+ */
+
+namespace nav
+{
+    /**
+     * @brief Reverse navigation maps to a set of gates, computed together in a single search. \n
+     *
+     * Every pose holds the distance to each gate and the first connection of the shortest path to it. Values are stored in lanes
+     * of 8 gates, the size of a 256-bit vector of floats, and relaxing a connection updates every lane of a pose at once with code
+     * that the compiler can vectorise. A pose is expanded again only when one of its lanes improved since it was expanded,
+     * with the smallest improved value as key, so the roadmap and the queue are walked once for all the gates instead of once per gate. \n
+     *
+     * The distance to the nearest gate and its index are kept for every pose as well, so the closest exit can be planned directly. \n
+     *
+     * The lane arithmetic costs more per connection than a scalar search, so with fewer than SINGLE_PASS_GATES gates
+     * each gate gets its own reverse NavMap instead.
+     *
+     * @see NavMap#computeReverse()
+     */
+    class GateMap
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef rm::FrozenRoadMap::pose_id pose_id;
+        /** Type for the ID of a connection */
+        typedef rm::FrozenRoadMap::edge_id edge_id;
+        /** Number of gates stored in a lane */
+        static const size_t LANE_SIZE = 8;
+        /** Smallest number of gates computed in a single search, below it every gate is searched on its own */
+        static const size_t SINGLE_PASS_GATES = 6;
+
+    private:
+        struct Lane
+        {
+            float dist[LANE_SIZE];
+        };
+
+        std::shared_ptr<const rm::Overlay> _overlay;
+        std::vector<pose_id> _gates;
+        size_t _lanes;
+        std::vector<Lane> _values;
+        std::vector<edge_id> _next;
+        std::vector<float> _key;
+        std::vector<float> _nearest_dist;
+        std::vector<uint32_t> _nearest_gate;
+        PoseHeap _queue;
+        size_t _expanded;
+        std::vector<NavMap> _maps;
+
+        inline float getDist(pose_id pose, size_t gate) const
+        {
+            // Reverse NavMaps store negative values
+            return _maps.empty() ? _values[pose * _lanes + gate / LANE_SIZE].dist[gate % LANE_SIZE] : -_maps[gate].getValue(pose);
+        }
+        inline edge_id getNext(pose_id pose, size_t gate) const { return _next[pose * _lanes * LANE_SIZE + gate]; }
+        void computeLanes();
+        void relax(pose_id from, pose_id to, edge_id e, float length);
+
+    public:
+        /**
+         * @brief GateMap constructor.
+         *
+         * @param[in] overlay   Overlay holding the gates. Its base roadmap is used as well.
+         */
+        GateMap(std::shared_ptr<const rm::Overlay> overlay);
+
+        /**
+         * @brief Compute the distances from every pose to every gate, in a single backward search from all of them.
+         *
+         * @param[in] gates Global IDs of the gate poses
+         */
+        void compute(const std::vector<pose_id> &gates);
+
+        /**
+         * @brief Get the number of gates.
+         *
+         * @return Number of gates of the last computation
+         */
+        inline size_t getGateCount() const { return _gates.size(); }
+
+        /**
+         * @brief Get the distance from a pose to a gate.
+         *
+         * @param[in] pose  Global ID of the pose
+         * @param[in] gate  Index of the gate, in the order given to compute()
+         * @return      Length of the shortest path, INFINITY if the gate cannot be reached
+         */
+        float getValue(pose_id pose, size_t gate) const;
+
+        /**
+         * @brief Get the distance from a pose to the nearest gate.
+         *
+         * @param[in] pose  Global ID of the pose
+         * @return      Length of the shortest path to any gate, INFINITY if none can be reached
+         */
+        float getNearestValue(pose_id pose) const;
+
+        /**
+         * @brief Get the gate nearest to a pose.
+         *
+         * @param[in] pose  Global ID of the pose
+         * @return      Index of the nearest gate, in the order given to compute()
+         */
+        size_t getNearestGate(pose_id pose) const;
+
+        /**
+         * @brief Plan the shortest path from a pose to a gate.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @param[in] gate      Index of the gate, in the order given to compute()
+         * @return          Planned path as a list of connection IDs
+         */
+        edgeList planEdgesFrom(pose_id source, size_t gate) const;
+
+        /**
+         * @brief Plan the shortest path from a pose to the nearest gate.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @return          Planned path as a list of connection IDs
+         *
+         * @see getNearestGate()
+         */
+        edgeList planEdgesFromNearest(pose_id source) const;
+
+        /**
+         * @brief Get the number of poses expanded by the last computation, as a measure of its cost.
+         *
+         * @return Number of poses taken from the priority queue
+         */
+        inline size_t getExpandedCount() const { return _expanded; }
+
+        /**
+         * @brief Check that every connection of a path is collision free.
+         *
+         * @param[in] path  Path to be validated
+         * @return      true if every connection of the path is collision free, false otherwise
+         *
+         * @see NavMap#validate()
+         */
+        bool validate(const edgeList &path) const;
+
+        /**
+         * @brief Validate a path planned on this GateMap and re-run the computation if it is not feasible.
+         *
+         * @param[in] path  Path planned with this GateMap
+         * @return      true if the path is feasible, false if the GateMap was re-computed and the path must be planned again
+         *
+         * @see NavMap#repair()
+         */
+        bool repair(const edgeList &path);
+    };
+}
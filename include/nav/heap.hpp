@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rm/frozen.hpp"
+
+/**
+ * @file heap.hpp
+ * @brief This file is dedicated to the PoseHeap class.
+ *
+ * @see nav#PoseHeap
+ */
+
+namespace nav
+{
+    /**
+     * @brief Indexed 4-ary min-heap of poses, used as the priority queue of the searches. \n
+     *
+     * Each pose is stored at most once, and the position of every pose in the heap is tracked, so that lowering its key moves it
+     * in place instead of removing and inserting it again. Storage is allocated by reset() for a given number of poses, and no allocation
+     * happens while searching. \n
+     *
+     * Poses with the same key are popped by increasing ID, in the same order as a std::set of (key, pose) pairs.
+     *
+     * @see NavMap
+     */
+    class PoseHeap
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef rm::FrozenRoadMap::pose_id pose_id;
+
+    private:
+        struct Entry
+        {
+            float key;
+            pose_id pose;
+        };
+
+        static const uint32_t NONE = UINT32_MAX;
+        std::vector<Entry> _heap;
+        std::vector<uint32_t> _position;
+
+        inline static bool less(const Entry &a, const Entry &b) { return a.key < b.key || (a.key == b.key && a.pose < b.pose); }
+        void siftUp(uint32_t index, Entry entry);
+        void siftDown(uint32_t index, Entry entry);
+
+    public:
+        /**
+         * @brief Empty the heap and make room for the given number of poses.
+         *
+         * @param[in] poses Number of poses, whose IDs are in range [0, poses)
+         */
+        void reset(size_t poses);
+
+        /** @brief Whether the heap holds no pose. */
+        inline bool empty() const { return _heap.empty(); }
+
+        /** @brief Number of poses in the heap. */
+        inline size_t size() const { return _heap.size(); }
+
+        /** @brief Pose stored at a position of the heap, in no particular order. */
+        inline pose_id getPose(size_t index) const { return _heap[index].pose; }
+
+        /** @brief Lowest key in the heap. The heap must not be empty. */
+        inline float getTopKey() const { return _heap[0].key; }
+
+        /** @brief Whether a pose is in the heap. */
+        inline bool contains(pose_id pose) const { return _position[pose] != NONE; }
+
+        /**
+         * @brief Insert a pose, or lower its key if it is already in the heap.
+         *
+         * @param[in] pose  ID of the pose
+         * @param[in] key   New key of the pose. If the pose is in the heap, it must not be greater than the current one
+         */
+        void push(pose_id pose, float key);
+
+        /**
+         * @brief Remove the pose with the lowest key.
+         *
+         * @return ID of the removed pose
+         */
+        pose_id pop();
+    };
+}
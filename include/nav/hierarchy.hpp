@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rm/frozen.hpp"
+
+/**
+ * @file hierarchy.hpp
+ * @brief This file is dedicated to the Hierarchy class.
+ *
+ * @see nav#Hierarchy
+ */
+
+namespace nav
+{
+    /**
+     * @brief Coarse abstraction of a roadmap, used to restrict searches to a corridor of the arena. \n
+     *
+     * The arena is split into square regions, each one holding the nodes inside it. Two regions are adjacent in the abstract graph
+     * when a connection joins poses in them, and the cost of the abstract edge is the length of the shortest such connection,
+     * which is computed once for all queries. \n
+     *
+     * A search on the abstract graph gives the sequence of regions from a source to each target, which is widened by the neighbouring regions
+     * and makes up the corridor where NavMap searches the pose-level graph. The cost of a query then depends on the length of the corridor
+     * instead of the size of the arena. Since visibility edges are long, most poses join several regions: regions are abstracted as a whole
+     * instead of through their portal poses.
+     *
+     * @see NavMap#compute(pose_id, const Hierarchy &, const std::vector<rm::RoadMap::node_id> &)
+     */
+    class Hierarchy
+    {
+    private:
+        std::shared_ptr<const rm::FrozenRoadMap> _graph;
+        float _region_size;
+        float _x0, _y0;
+        size_t _columns, _rows;
+        std::vector<size_t> _node_region;
+        std::vector<std::vector<std::pair<size_t, float>>> _adjacent;
+
+    public:
+        /**
+         * @brief Build the abstraction of a roadmap.
+         *
+         * @param[in] graph         Frozen image of the roadmap
+         * @param[in] regionSize    Side of the square regions
+         */
+        Hierarchy(std::shared_ptr<const rm::FrozenRoadMap> graph, float regionSize);
+
+        /**
+         * @brief Get the roadmap the abstraction was built on.
+         *
+         * @return Frozen image of the roadmap
+         */
+        const rm::FrozenRoadMap &getGraph() const;
+
+        /** @brief Number of regions, including the empty ones. */
+        inline size_t getRegionCount() const { return _columns * _rows; }
+
+        /** @brief Number of edges of the abstract graph. */
+        size_t getAbstractEdgeCount() const;
+
+        /**
+         * @brief Get the region holding a point. Points outside the roadmap belong to the closest region.
+         *
+         * @param[in] x     x-coordinate of the point
+         * @param[in] y     y-coordinate of the point
+         * @return      ID of the region
+         */
+        size_t getRegion(float x, float y) const;
+
+        /** @brief Region holding a node of the roadmap. */
+        inline size_t getRegion(rm::RoadMap::node_id node) const { return _node_region[node]; }
+
+        /**
+         * @brief Find the corridor joining a region to a set of regions.
+         *
+         * @param[in] source    Region of the source
+         * @param[in] targets   Regions of the targets. Unreachable ones are left out of the corridor
+         * @return          Flag for each region, true if it belongs to the corridor
+         */
+        std::vector<bool> getCorridor(size_t source, const std::vector<size_t> &targets) const;
+    };
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rm/frozen.hpp"
+#include "rm/overlay.hpp"
+
+/**
+ * @file landmarks.hpp
+ * @brief This file is dedicated to the Landmarks class.
+ *
+ * @see nav#Landmarks
+ */
+
+namespace nav
+{
+    /**
+     * @brief Distances between every pose of a roadmap and a few landmark poses, giving lower bounds of the distance between any two poses. \n
+     *
+     * By the triangle inequality, the distance from a pose to a goal is at least the distance from the pose to a landmark minus the one
+     * from the goal to the same landmark, and at least the distance from the landmark to the goal minus the one from the landmark to the pose.
+     * The best bound over all the landmarks is used as the heuristic of NavMap#planAStar(), which is tight when the goal lies
+     * between the pose and a landmark, or a landmark behind the pose: landmarks are therefore chosen at the extremities of the roadmap. \n
+     *
+     * Distances are stored for every pose and landmark in both directions, so memory is linear in the number of landmarks times the poses.
+     * Poses of an Overlay have no stored distance, and their bounds are derived from the poses of the roadmap they are connected to. \n
+     *
+     * Invalid connections of lazy roadmaps found after the landmarks are computed only make paths longer, so bounds are still valid.
+     *
+     * @see NavMap#planAStar()
+     */
+    class Landmarks
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef rm::FrozenRoadMap::pose_id pose_id;
+
+        /**
+         * @brief Bounds of the distances between a pose and every landmark, exact for the poses of the roadmap.
+         *
+         * @see getRow()
+         */
+        struct Row
+        {
+            /** Lower bounds of the distances from the pose to each landmark */
+            std::vector<float> to_lower;
+            /** Upper bounds of the distances from the pose to each landmark */
+            std::vector<float> to_upper;
+            /** Lower bounds of the distances from each landmark to the pose */
+            std::vector<float> from_lower;
+            /** Upper bounds of the distances from each landmark to the pose */
+            std::vector<float> from_upper;
+        };
+
+    private:
+        std::shared_ptr<const rm::FrozenRoadMap> _graph;
+        std::vector<pose_id> _landmarks;
+        std::vector<float> _to;
+        std::vector<float> _from;
+
+    public:
+        /**
+         * @brief Choose the landmarks of a roadmap and compute their distances to and from every pose. \n
+         *
+         * The first landmark is the pose farthest from the pose with the most connections in both directions, and every following one is
+         * the pose farthest from the closest landmark chosen so far, measuring the distance to a pose and back so that dead ends are not chosen.
+         *
+         * @param[in] graph Frozen roadmap
+         * @param[in] count Optional: number of landmarks
+         */
+        Landmarks(std::shared_ptr<const rm::FrozenRoadMap> graph, size_t count = 8);
+
+        /**
+         * @brief Get the frozen roadmap of the landmarks.
+         *
+         * @return Associated FrozenRoadMap object
+         */
+        const rm::FrozenRoadMap &getGraph() const;
+
+        /** @brief Number of landmarks. */
+        inline size_t getCount() const { return _landmarks.size(); }
+
+        /** @brief Global ID of a landmark pose. */
+        inline pose_id getLandmark(size_t index) const { return _landmarks[index]; }
+
+        /**
+         * @brief Get the memory taken by the stored distances.
+         *
+         * @return Size of the distances in bytes
+         */
+        size_t getMemorySize() const;
+
+        /**
+         * @brief Get the bounds of the distances between a pose and every landmark.
+         *
+         * @param[in]  pose      Global ID of the pose
+         * @param[out] row       Out: Bounds of the distances
+         * @param[in]  overlay   Optional: Overlay the pose belongs to, required for the poses that are not in the roadmap
+         */
+        void getRow(pose_id pose, Row &row, const rm::Overlay *overlay = nullptr) const;
+
+        /**
+         * @brief Get a lower bound of the distance between two poses from the bounds of their distances to the landmarks.
+         *
+         * @param[in] from  Bounds of the source pose
+         * @param[in] to    Bounds of the goal pose
+         * @return      Lower bound of the length of the shortest path, 0 if none is known
+         */
+        float getLowerBound(const Row &from, const Row &to) const;
+
+        /**
+         * @brief Get a lower bound of the distance from a pose of the roadmap to a goal, reading the stored distances of the pose directly.
+         *
+         * @param[in] from  Global ID of the source pose, which must be a pose of the roadmap
+         * @param[in] to    Bounds of the goal pose
+         * @return      Lower bound of the length of the shortest path, 0 if none is known
+         */
+        float getLowerBound(pose_id from, const Row &to) const;
+    };
+}
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include <deque>
+#include <functional>
+#include <memory>
 
 #include "rm/roadmap.hpp"
+#include "rm/frozen.hpp"
+#include "rm/overlay.hpp"
 #include "nav/path.hpp"
+#include "nav/hierarchy.hpp"
+#include "nav/heap.hpp"
+#include "nav/landmarks.hpp"
 
 /**
  * @file NavMap.hpp
@@ -24,17 +33,75 @@ namespace nav
     /**
      * @brief Class to create pre-computed navigation maps for a RoadMap.\n
      * 
+     * Searches run on the frozen image of the RoadMap, where every pose has a global ID.
+     * A NavMap can also run directly on an image mapped from another process: in that case paths are given as connection IDs. \n
+     *
+     * When created on an Overlay, searches run on the base roadmap and on the query-specific poses of the overlay together.
+     * The base roadmap is never modified, so NavMap objects of different threads can share it.
+     * Poses must be added to the overlay before computing.
+     *
      * @see rm::RoadMap
+     * @see rm::FrozenRoadMap
+     * @see rm::Overlay
      */
     class NavMap
     {
+    public:
+        /** Type for the global ID of a pose */
+        typedef rm::FrozenRoadMap::pose_id pose_id;
+        /** Type for the ID of a connection */
+        typedef rm::FrozenRoadMap::edge_id edge_id;
+
     private:
-        std::vector<std::vector<float>> _dist;
-        std::vector<std::vector<rm::RoadMap::DubinsConnection const *>> _connection;
-        const rm::RoadMap &_rm;
+        std::shared_ptr<const rm::FrozenRoadMap> _graph;
+        std::shared_ptr<const rm::Overlay> _overlay;
+        struct Label
+        {
+            float dist;
+            uint32_t generation;
+        };
+
+        std::vector<Label> _labels;
+        std::vector<edge_id> _connection;
+        std::vector<float> _estimate;
+        std::vector<uint32_t> _target;
+        std::vector<Label> _backward;
+        std::vector<edge_id> _backward_connection;
+        PoseHeap _queue;
+        PoseHeap _backward_queue;
+        pose_id _origin;
+        uint32_t _generation;
+        size_t _expanded;
+        float _radius;
         bool _need_computing;
         bool _reverse;
 
+        pose_id getPoseID(const rm::RoadMap::Node::Orientation &pose) const;
+        void search(pose_id source, const std::vector<bool> *allowed, float budget, const std::vector<rm::RoadMap::node_id> *targets);
+        edgeList searchAStar(pose_id source, pose_id goal, const std::function<float(pose_id)> &heuristic);
+        navList toNavList(const edgeList &edges) const;
+
+        // Labels of older generations hold the values of a pose that was not reached
+        inline float getDist(pose_id pose) const { return _labels[pose].generation == _generation ? _labels[pose].dist : (_reverse ? -INFINITY : INFINITY); }
+        inline edge_id getConnection(pose_id pose) const { return _labels[pose].generation == _generation ? _connection[pose] : rm::FrozenRoadMap::NONE; }
+        inline void setLabel(pose_id pose, float dist, edge_id connection)
+        {
+            _labels[pose] = Label{dist, _generation};
+            _connection[pose] = connection;
+        }
+
+        inline size_t getNodeCount() const { return _overlay ? _overlay->getNodeCount() : _graph->getNodeCount(); }
+        inline size_t getPoseCount() const { return _overlay ? _overlay->getPoseCount() : _graph->getPoseCount(); }
+        inline pose_id getFrom(edge_id edge) const { return _overlay ? _overlay->getFrom(edge) : _graph->getFrom(edge); }
+        inline pose_id getTo(edge_id edge) const { return _overlay ? _overlay->getTo(edge) : _graph->getTo(edge); }
+        inline float getLength(edge_id edge) const { return _overlay ? _overlay->getLength(edge) : _graph->getLength(edge); }
+        inline pose_id getFirstPose(rm::RoadMap::node_id node) const { return _overlay ? _overlay->getFirstPose(node) : _graph->getFirstPose(node); }
+        inline size_t getPosesCount(rm::RoadMap::node_id node) const { return _overlay ? _overlay->getPosesCount(node) : _graph->getPosesCount(node); }
+        inline rm::RoadMap::node_id getNode(pose_id pose) const { return _overlay ? _overlay->getNode(pose) : _graph->getNode(pose); }
+        inline float getX(pose_id pose) const { return _overlay ? _overlay->getX(pose) : _graph->getX(_graph->getNode(pose)); }
+        inline float getY(pose_id pose) const { return _overlay ? _overlay->getY(pose) : _graph->getY(_graph->getNode(pose)); }
+        inline float getTheta(pose_id pose) const { return _overlay ? _overlay->getTheta(pose) : _graph->getTheta(pose); }
+
     public:
         /**
          * @brief NavMap constructor.
@@ -43,6 +110,27 @@ namespace nav
          */
         NavMap(const rm::RoadMap &roadmap);
 
+        /**
+         * @brief NavMap constructor for a frozen image, such as one mapped from another process.
+         *
+         * @param[in] graph Associated FrozenRoadMap object.
+         */
+        NavMap(std::shared_ptr<const rm::FrozenRoadMap> graph);
+
+        /**
+         * @brief NavMap constructor for a roadmap extended with query-specific poses.
+         *
+         * @param[in] overlay   Associated Overlay object. Its base roadmap is used as well.
+         */
+        NavMap(std::shared_ptr<const rm::Overlay> overlay);
+
+        /**
+         * @brief Get the frozen image this NavMap runs on.
+         *
+         * @return Associated FrozenRoadMap object
+         */
+        const rm::FrozenRoadMap &getGraph() const;
+
         /**
          * @brief Pre-compute the navigation map for direct planning.\n 
          * 
@@ -56,6 +144,47 @@ namespace nav
          */
         void compute(const rm::RoadMap::Node::Orientation &source);
 
+        /**
+         * @brief Pre-compute the navigation map for direct planning from a pose given by its global ID.
+         *
+         * @param[in] source Global ID of the source pose
+         *
+         * @see compute()
+         */
+        void compute(pose_id source);
+
+        /**
+         * @brief Pre-compute the navigation map for direct planning, stopping as soon as the values that are needed are known. \n
+         *
+         * Poses are settled by increasing distance, as in compute(), until the next one is farther than the budget or a pose of every
+         * target node has been settled. Values of the poses that were not settled are left to infinity, while the ones of the settled poses,
+         * and so the values of the target nodes, are the same as the ones of a full computation.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @param[in] budget    Maximum distance to be explored. INFINITY to stop on the targets only
+         * @param[in] targets   Optional: nodes whose values are needed. If empty, the search stops on the budget only
+         *
+         * @see compute()
+         * @see intercept()
+         */
+        void compute(pose_id source, float budget, const std::vector<rm::RoadMap::node_id> &targets = std::vector<rm::RoadMap::node_id>());
+
+        /**
+         * @brief Pre-compute the navigation map for direct planning, exploring only the corridor that joins the source to a set of target nodes. \n
+         *
+         * The corridor is found on the abstract graph of the hierarchy, then the pose-level search is restricted to its nodes and to the poses
+         * of the overlay. Values of the poses outside the corridor are left to infinity, and values inside it can be longer than the ones
+         * of a full search when the shortest path leaves the corridor. If a target cannot be reached within the corridor, the full roadmap is explored.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @param[in] hierarchy Abstraction of the base roadmap
+         * @param[in] targets   Nodes the paths will be planned to
+         *
+         * @see compute()
+         * @see Hierarchy
+         */
+        void compute(pose_id source, const Hierarchy &hierarchy, const std::vector<rm::RoadMap::node_id> &targets);
+
         /**
          * @brief Pre-compute the navigation map for reverse planning.\n 
          * 
@@ -69,6 +198,101 @@ namespace nav
          */
         void computeReverse(const rm::RoadMap::Node::Orientation &goal);
 
+        /**
+         * @brief Pre-compute the navigation map for reverse planning to a pose given by its global ID.
+         *
+         * @param[in] goal Global ID of the goal pose
+         *
+         * @see computeReverse()
+         */
+        void computeReverse(pose_id goal);
+
+        /**
+         * @brief Plan the shortest path between two poses with an A* search, which stops as soon as the goal is reached. \n
+         *
+         * Poses are explored by their distance from the source plus a lower bound of their distance to the goal: the straight line,
+         * or the Dubins path when the maximum curvature is given, which is tighter but more expensive to evaluate.
+         * Only the poses that could lie on a shorter path are expanded, so a single query is faster than compute() and planEdgesTo(). \n
+         *
+         * The values left by the search are not a complete navigation map: compute() is required again before other plans.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @param[in] goal      Global ID of the goal pose
+         * @param[in] kmax      Optional: maximum curvature of Dubins paths for the Dubins lower bound. If 0, the straight line is used
+         * @return          Planned path as a list of connection IDs
+         *
+         * @see compute()
+         * @see getExpandedCount()
+         */
+        edgeList planAStar(pose_id source, pose_id goal, float kmax = 0.0f);
+
+        /**
+         * @brief Plan the shortest path between two poses with an A* search bounded by the distances to a set of landmarks. \n
+         *
+         * The remaining length is bounded by the largest of the straight line and of the triangle inequality through each landmark,
+         * which follows the obstacles around the landmarks and is far tighter than the straight line when the goal lies behind them.
+         * The values left by the search are not a complete navigation map: compute() is required again before other plans.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @param[in] goal      Global ID of the goal pose
+         * @param[in] landmarks Landmarks of the base roadmap
+         * @return          Planned path as a list of connection IDs
+         *
+         * @see Landmarks
+         * @see planAStar(pose_id, pose_id, float)
+         */
+        edgeList planAStar(pose_id source, pose_id goal, const Landmarks &landmarks);
+
+        /**
+         * @brief Plan the shortest path between two poses with a bidirectional search. \n
+         *
+         * Poses are expanded forward from the source and backward from the goal, always on the side whose next pose is closer.
+         * The search stops when the sum of the next distances of both sides is not shorter than the best path through a pose reached
+         * by both, so each side explores roughly the ball of half the length of the path instead of the whole one. \n
+         *
+         * The values left by the search are not a complete navigation map: compute() is required again before other plans.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @param[in] goal      Global ID of the goal pose
+         * @return          Planned path as a list of connection IDs
+         *
+         * @see compute()
+         * @see computeReverse()
+         * @see getExpandedCount()
+         */
+        edgeList planBidirectional(pose_id source, pose_id goal);
+
+        /**
+         * @brief Plan the shortest path between two poses of the RoadMap with a bidirectional search.
+         *
+         * @param[in] source    Source pose
+         * @param[in] goal      Goal pose
+         * @return          Planned path
+         *
+         * @see planBidirectional(pose_id, pose_id)
+         * @see navList
+         */
+        navList planBidirectional(const rm::RoadMap::Node::Orientation &source, const rm::RoadMap::Node::Orientation &goal);
+
+        /**
+         * @brief Get the number of poses expanded by the last search, as a measure of its cost.
+         *
+         * @return Number of poses taken from the priority queue
+         */
+        inline size_t getExpandedCount() const { return _expanded; }
+
+        /**
+         * @brief Get the distance from the source within which the values of the last forward computation are the shortest ones. \n
+         *
+         * Poses that were not settled are at least this far from the source. The radius is infinite after a full computation,
+         * and 0 after the searches whose values are not the shortest ones.
+         *
+         * @return Radius of the settled poses
+         *
+         * @see compute(pose_id, float, const std::vector<rm::RoadMap::node_id> &)
+         */
+        inline float getSettledRadius() const { return _radius; }
+
         /**
          * @brief Clear all pre-computed values. Called automatically before every new computation.
          * 
@@ -108,6 +332,39 @@ namespace nav
          */
         navList planFrom(const rm::RoadMap::Node::Orientation &source) const;
 
+        /**
+         * @brief Plan the shortest path to a pose given by its global ID. Requires forward pre-computation.
+         *
+         * @param[in] goal  Global ID of the goal pose
+         * @return      Planned path as a list of connection IDs
+         *
+         * @see compute()
+         * @see edgeList
+         */
+        edgeList planEdgesTo(pose_id goal) const;
+
+        /**
+         * @brief Plan the shortest path from a pose given by its global ID. Requires reverse pre-computation.
+         *
+         * @param[in] source    Global ID of the source pose
+         * @return          Planned path as a list of connection IDs
+         *
+         * @see computeReverse()
+         * @see edgeList
+         */
+        edgeList planEdgesFrom(pose_id source) const;
+
+        /**
+         * @brief Plan the shortest path to a node given by its ID, regardless of the orientation. Requires forward pre-computation.
+         *
+         * @param[in] goal  ID of the goal node
+         * @return      Planned path as a list of connection IDs
+         *
+         * @see compute()
+         * @see edgeList
+         */
+        edgeList planEdgesToNode(rm::RoadMap::node_id goal) const;
+
         /**
          * @brief Plan the shortest path that intercepts another path. Requires forward pre-computation. \n 
          * 
@@ -122,6 +379,76 @@ namespace nav
          */
         navList intercept(const navList &path, float offset = 0.0f) const;
 
+        /**
+         * @brief Plan the shortest path that intercepts another path given as a list of connection IDs. Requires forward pre-computation.
+         *
+         * @param[in] path      Path to be intercepted
+         * @param[in] offset    From which length of the given path the actual path should start at present.
+         * @return          Planned path as a list of connection IDs
+         *
+         * @see intercept()
+         */
+        edgeList intercept(const edgeList &path, float offset = 0.0f) const;
+
+        /**
+         * @brief Check that every connection of a path is collision free. \n
+         *
+         * Connections of roadmaps built in lazy mode are validated on demand and their state is cached in the RoadMap.
+         * Invalid connections are skipped by every following computation.
+         *
+         * @param[in] path  Path to be validated
+         * @return      true if every connection of the path is collision free, false otherwise
+         *
+         * @see rm::RoadMap#validate()
+         */
+        bool validate(const navList &path) const;
+
+        /**
+         * @brief Check that every connection of a path given as a list of connection IDs is collision free.
+         *
+         * @param[in] path  Path to be validated
+         * @return      true if every connection of the path is collision free, false otherwise
+         *
+         * @see validate()
+         */
+        bool validate(const edgeList &path) const;
+
+        /**
+         * @brief Validate a path planned on this NavMap and re-run the last computation if it is not feasible. \n
+         *
+         * This implements the lazy search loop: the path is planned on the optimistic graph, its connections are checked,
+         * and the search is repeated without the connections found invalid until a feasible path is returned.
+         *
+         * @param[in] path  Path planned with this NavMap
+         * @return      true if the path is feasible, false if the NavMap was re-computed and the path must be planned again
+         *
+         * @see validate()
+         */
+        bool repair(const navList &path);
+
+        /**
+         * @brief Validate a path given as a list of connection IDs and re-run the last computation if it is not feasible.
+         *
+         * @param[in] path  Path planned with this NavMap
+         * @return      true if the path is feasible, false if the NavMap was re-computed and the path must be planned again
+         *
+         * @see repair()
+         */
+        bool repair(const edgeList &path);
+
+        /**
+         * @brief Plan the shortest feasible path between two poses on a lazily built roadmap. \n
+         *
+         * The forward navigation map is computed from the source and re-computed every time a connection of the planned path turns out invalid.
+         *
+         * @param[in] source    Source pose
+         * @param[in] goal      Goal pose
+         * @return          Planned path
+         *
+         * @see repair()
+         */
+        navList planLazy(const rm::RoadMap::Node::Orientation &source, const rm::RoadMap::Node::Orientation &goal);
+
         /**
          * @brief Return true if NavMap was pre-computed with computeReverse.
          * 
@@ -141,6 +468,15 @@ namespace nav
          * @see computeReverse()
          */
         float getValue(const rm::RoadMap::Node::Orientation &pose) const;
+
+        /**
+         * @brief Get the pre-computed value stored for a pose given by its global ID.
+         *
+         * @param[in] pose  Global ID of the pose
+         * @return      Pre-computed value
+         */
+        float getValue(pose_id pose) const;
+
         /**
          * @brief Get the smallest pre-computed value stored for a given position.
          * 
@@ -151,5 +487,13 @@ namespace nav
          * @see computeReverse()
          */
         float getValue(const rm::RoadMap::Node &node) const;
+
+        /**
+         * @brief Get the smallest pre-computed value stored for a node given by its ID.
+         *
+         * @param[in] node  ID of the node
+         * @return      Best pre-computed value
+         */
+        float getNodeValue(rm::RoadMap::node_id node) const;
     };
 }
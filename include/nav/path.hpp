@@ -1,6 +1,8 @@
 #pragma once
 
 #include "rm/roadmap.hpp"
+#include "rm/frozen.hpp"
+#include "rm/overlay.hpp"
 
 #include <deque>
 
@@ -11,6 +13,7 @@
  * @see nav
  * @see nav#navList
  * @see nav#discretizePath()
+ * @see nav#refinePath()
  * @see nav#truncatePaths()
  */
 
@@ -22,6 +25,12 @@ namespace nav
      */
     typedef std::deque<rm::RoadMap::DubinsConnection const *> navList;
 
+    /**
+     * @brief Type describing a navigation path on a FrozenRoadMap. It contains a list of connection IDs that are to be followed in order.
+     *
+     */
+    typedef std::deque<rm::FrozenRoadMap::edge_id> edgeList;
+
     /**
      * @brief Discretize a navigation path. Supports wait connections.
      * 
@@ -31,6 +40,51 @@ namespace nav
      */
     void discretizePath(const navList &nav_list, float step, std::vector<Pose> &discr_path);
 
+    /**
+     * @brief Discretize a navigation path given on a FrozenRoadMap.
+     *
+     * @param[in]  graph         FrozenRoadMap the path was planned on
+     * @param[in]  edge_list     Navigation path to be discretized
+     * @param[in]  step          Discretization step
+     * @param[out] discr_path    Out: Discretized path
+     */
+    void discretizePath(const rm::FrozenRoadMap &graph, const edgeList &edge_list, float step, std::vector<Pose> &discr_path);
+
+    /**
+     * @brief Discretize a navigation path given on a roadmap extended by an Overlay. Supports wait connections.
+     *
+     * @param[in]  overlay       Overlay the path was planned on
+     * @param[in]  edge_list     Navigation path to be discretized
+     * @param[in]  step          Discretization step
+     * @param[out] discr_path    Out: Discretized path
+     */
+    void discretizePath(const rm::Overlay &overlay, const edgeList &edge_list, float step, std::vector<Pose> &discr_path);
+
+    /**
+     * @brief Optimize the headings of the via points of a navigation path, which are limited to the poses of the roadmap by the graph search. \n
+     *
+     * Headings are improved by iterative dynamic programming: each intermediate via point is given a window of candidate headings around
+     * the current one, the sequence of headings giving the shortest collision-free chain of Dubins paths is kept, and the window is narrowed
+     * around it at the next iteration. The current headings are among the candidates, so that the refined path is never longer than the given one. \n
+     *
+     * The positions of the via points, the headings at the ends of the path and the poses of wait connections are kept.
+     * Refined paths are added to the overlay as connections that are not followed by graph searches.
+     *
+     * @param[in,out] overlay     Overlay the path was planned on, extended with the refined connections
+     * @param[in]     edge_list   Navigation path to be refined
+     * @param[in]     kmax        Maximum curvature of Dubins paths
+     * @param[in]     obstacles   Obstacles for collision checking
+     * @param[in]     borders     Borders for collision checking
+     * @param[in]     samples     Optional: number of candidate headings on each side of the current one
+     * @param[in]     iterations  Optional: number of refinement iterations, each halving the window of candidate headings
+     * @return                Refined navigation path, with the same via points and wait connections as the given one
+     *
+     * @see rm#Overlay#addPath()
+     */
+    edgeList refinePath(rm::Overlay &overlay, const edgeList &edge_list, float kmax,
+                        const std::vector<Polygon> &obstacles, const Polygon &borders,
+                        unsigned int samples = 4, unsigned int iterations = 4);
+
     /**
      * @brief Truncate two navigation paths at the collision point.
      * 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "nav/navmap.hpp"
+#include "nav/gatemap.hpp"
+#include "nav/table.hpp"
+#include "nav/replanner.hpp"
 
 #include <vector>
 
@@ -26,14 +29,16 @@ namespace nav
      * but it would surely be possible to make a prediction of the gate the evader is heading to based on its short-term past motion. 
      * This implementation, however, takes the current goal for known at planning time, making it a simpler deterministic scenario.
      * 
-     * @param[in]  nm_e          Vector of backward-computed navigation maps to all the gates in the arena.
-     * @param[in]  nm_p          Navigation map used by the pursuer and re-computed several times throughout the game.
+     * @param[in]  gates         Backward-computed navigation maps to all the gates in the arena. They are re-computed if the roadmap was built in lazy mode and a planned path is not feasible.
+     * @param[in]  replanner     Planner of the pursuer, searching again only when its previous search is not enough to plan the next move.
+     * @param[in]  overlay       Overlay holding the starting poses and the gates. Wait connections of the pursuer are added to it.
      * @param[in]  source_e      Starting pose of the evader.
      * @param[in]  source_p      Starting pose of the pursuer.
      * @param[out] nav_list_e    Out: Navigation path of the evader throughout the game.
      * @param[out] nav_list_p    Out: Navigation path of the pursuer throughout the game.
+     * @param[in]  table         Optional: all-pairs table of the base roadmap, replacing the searches of the pursuer with lookups.
      */
-    void runGame(const std::vector<nav::NavMap> &nm_e, nav::NavMap &nm_p,
-                 const rm::RoadMap::Node::Orientation &source_e, const rm::RoadMap::Node::Orientation &source_p,
-                 nav::navList &nav_list_e, nav::navList &nav_list_p);
+    void runGame(nav::GateMap &gates, nav::Replanner &replanner, rm::Overlay &overlay,
+                 rm::Overlay::pose_id source_e, rm::Overlay::pose_id source_p,
+                 nav::edgeList &nav_list_e, nav::edgeList &nav_list_p, const nav::DistanceTable *table = nullptr);
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+
+#include "rm/overlay.hpp"
+#include "nav/navmap.hpp"
+#include "nav/hierarchy.hpp"
+
+/**
+ * @file replanner.hpp
+ * @brief This file is dedicated to the Replanner class.
+ *
+ * @see nav#Replanner
+ */
+
+namespace nav
+{
+    /**
+     * @brief Incremental planner for a source moving along its own shortest paths, as the pursuer does. \n
+     *
+     * The last search is kept as long as the source is a pose it settled. The poses whose shortest path from the old source
+     * goes through the new one keep their paths, and their distances are shorter by the distance of the new source.
+     * For every other pose, the distance from the old source minus the one of the new source is a lower bound, by the triangle inequality.
+     * A query is answered from the last search when these values decide it, and a new search is run only otherwise. \n
+     *
+     * Answers are the same as the ones of a full computation from the current source. Searches run on a NavMap and stop as soon as
+     * the nodes of the query are settled, so the lower bound of the poses that were not settled comes from the radius of the search. \n
+     *
+     * The bounds hold only while the distances of the last search do: the search is dropped when a connection on the path to the new source
+     * turns out to be invalid, and poses added to the overlay after it are bounded by the radius as well.
+     *
+     * @see NavMap#compute(pose_id, float, const std::vector<rm::RoadMap::node_id> &)
+     * @see NavMap#intercept()
+     */
+    class Replanner
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef NavMap::pose_id pose_id;
+
+    private:
+        NavMap &_map;
+        const rm::Overlay &_overlay;
+        const Hierarchy *_hierarchy;
+        pose_id _root;
+        size_t _pose_count;
+        size_t _steps, _searches, _expanded;
+
+        void search(pose_id source, const std::vector<rm::RoadMap::node_id> &targets);
+        bool canReuse(pose_id source) const;
+        bool isBelow(pose_id pose, pose_id source, float shift) const;
+        void evaluate(rm::RoadMap::node_id node, pose_id source, float &exact, pose_id &best, float &lower) const;
+        edgeList planSuffix(pose_id goal, pose_id source) const;
+
+    public:
+        /**
+         * @brief Replanner constructor.
+         *
+         * @param[in] map       Navigation map used for the searches, built on the overlay
+         * @param[in] overlay   Overlay holding the poses of the queries
+         * @param[in] hierarchy Optional: abstraction of the base roadmap restricting the searches. Their values are not the shortest ones,
+         *                      so every query runs a new search
+         */
+        Replanner(NavMap &map, const rm::Overlay &overlay, const Hierarchy *hierarchy = nullptr);
+
+        /**
+         * @brief Plan the shortest path from a source that intercepts another path, as NavMap#intercept() does.
+         *
+         * @param[in] source    Global ID of the current source
+         * @param[in] path      Path to be intercepted
+         * @param[in] offset    From which length of the given path the actual path should start at present
+         * @return          Planned path as a list of connection IDs
+         */
+        edgeList intercept(pose_id source, const edgeList &path, float offset = 0.0f);
+
+        /**
+         * @brief Plan the shortest path from a source to a node, regardless of the orientation, as NavMap#planEdgesToNode() does.
+         *
+         * @param[in] source    Global ID of the current source
+         * @param[in] goal      ID of the goal node
+         * @return          Planned path as a list of connection IDs
+         */
+        edgeList planEdgesToNode(pose_id source, rm::RoadMap::node_id goal);
+
+        /**
+         * @brief Validate a planned path, and drop the last search if it is not feasible. \n
+         *
+         * Invalid connections are skipped by the following searches, so the path must be planned again with a new one.
+         *
+         * @param[in] path  Path planned with this Replanner
+         * @return      true if the path is feasible, false if it must be planned again
+         *
+         * @see NavMap#validate()
+         */
+        bool repair(const edgeList &path);
+
+        /**
+         * @brief Drop the last search, so that the next query runs a new one.
+         */
+        void reset();
+
+        /** @brief Number of queries answered so far. */
+        inline size_t getStepCount() const { return _steps; }
+
+        /** @brief Number of queries that required a new search. The other ones were answered from the last search. */
+        inline size_t getSearchCount() const { return _searches; }
+
+        /** @brief Number of poses expanded by all the searches. */
+        inline size_t getExpandedCount() const { return _expanded; }
+    };
+}
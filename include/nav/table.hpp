@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "rm/frozen.hpp"
+#include "rm/overlay.hpp"
+#include "nav/path.hpp"
+
+/**
+ * @file table.hpp
+ * @brief This file is dedicated to the DistanceTable class.
+ *
+ * @see nav#DistanceTable
+ */
+
+namespace nav
+{
+    /**
+     * @brief Pre-computed shortest paths between every pair of poses of a roadmap, for plans without any search at query time. \n
+     *
+     * The table is built once from a frozen roadmap, with a search from every pose run on a pool of threads. For every pair of poses
+     * it stores the distance as a 16-bit float and the next connection of the shortest path as its 16-bit index among the
+     * connections leaving the pose, so 4 bytes per pair: a roadmap of 3000 poses takes 36 MB. Distances are rounded
+     * to 11 significant bits, which is about 0.05%, while paths within the roadmap are the exact shortest ones. \n
+     *
+     * Queries on an Overlay join the table to a small search over the poses of the overlay, assuming that they are start and goal poses
+     * whose connections lead into and out of the roadmap, as the ones of Overlay#addStartPose() and Overlay#addGoalPose(). \n
+     *
+     * Invalid connections of lazy roadmaps are found at query time, after the table is built, so lazy roadmaps are not supported.
+     *
+     * @see NavMap#intercept()
+     */
+    class DistanceTable
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef rm::FrozenRoadMap::pose_id pose_id;
+        /** Type for the ID of a connection */
+        typedef rm::FrozenRoadMap::edge_id edge_id;
+
+    private:
+        struct Label
+        {
+            float dist;
+            edge_id connection;
+        };
+        typedef std::unordered_map<pose_id, Label> LabelMap;
+
+        std::shared_ptr<const rm::FrozenRoadMap> _graph;
+        size_t _n_poses;
+        std::vector<uint16_t> _dist;
+        std::vector<uint16_t> _next;
+
+        void searchFrom(pose_id source, std::vector<float> &dist, std::vector<uint16_t> &first) const;
+        void searchOverlay(const rm::Overlay &overlay, pose_id pose, bool forward, LabelMap &labels) const;
+        float getValue(const LabelMap &from, const LabelMap &to, pose_id goal, pose_id &entry, pose_id &exit) const;
+        float getNodeValue(const rm::Overlay &overlay, const LabelMap &from, rm::RoadMap::node_id node, LabelMap &to, pose_id &goal, pose_id &entry, pose_id &exit) const;
+        edgeList unroll(const rm::Overlay &overlay, const LabelMap &from, const LabelMap &to, pose_id goal, pose_id entry, pose_id exit) const;
+        void checkOverlay(const rm::Overlay &overlay) const;
+
+    public:
+        /**
+         * @brief Build the table of a roadmap.
+         *
+         * @param[in] graph     Frozen roadmap, whose connections must have been validated
+         * @param[in] threads   Optional: number of worker threads. If 0, one per hardware thread
+         */
+        DistanceTable(std::shared_ptr<const rm::FrozenRoadMap> graph, unsigned int threads = 0);
+
+        /**
+         * @brief Get the frozen roadmap of the table.
+         *
+         * @return Associated FrozenRoadMap object
+         */
+        const rm::FrozenRoadMap &getGraph() const;
+
+        /**
+         * @brief Get the memory taken by the table.
+         *
+         * @return Size of the table in bytes
+         */
+        size_t getMemorySize() const;
+
+        /**
+         * @brief Get the shortest distance between two poses of the roadmap.
+         *
+         * @param[in] from  Global ID of the source pose
+         * @param[in] to    Global ID of the goal pose
+         * @return      Length of the shortest path, rounded to 16-bit float. INFINITY if the goal cannot be reached
+         */
+        float getDistance(pose_id from, pose_id to) const;
+
+        /**
+         * @brief Plan the shortest path between two poses of the roadmap.
+         *
+         * @param[in] from  Global ID of the source pose
+         * @param[in] to    Global ID of the goal pose
+         * @return      Planned path as a list of connection IDs
+         */
+        edgeList planEdges(pose_id from, pose_id to) const;
+
+        /**
+         * @brief Plan the shortest path between two poses of an overlay of the roadmap.
+         *
+         * @param[in] overlay   Overlay of the roadmap of the table
+         * @param[in] source    Global ID of the source pose
+         * @param[in] goal      Global ID of the goal pose
+         * @return          Planned path as a list of connection IDs
+         */
+        edgeList planEdgesTo(const rm::Overlay &overlay, pose_id source, pose_id goal) const;
+
+        /**
+         * @brief Plan the shortest path from a pose of an overlay to a node, regardless of the orientation.
+         *
+         * @param[in] overlay   Overlay of the roadmap of the table
+         * @param[in] source    Global ID of the source pose
+         * @param[in] goal      ID of the goal node
+         * @return          Planned path as a list of connection IDs
+         */
+        edgeList planEdgesToNode(const rm::Overlay &overlay, pose_id source, rm::RoadMap::node_id goal) const;
+
+        /**
+         * @brief Plan the shortest path that intercepts another path, as NavMap#intercept() does, from table lookups only.
+         *
+         * If interception is not possible, it plans the shortest path to the last position of the given path.
+         *
+         * @param[in] overlay   Overlay of the roadmap of the table
+         * @param[in] source    Global ID of the source pose
+         * @param[in] path      Path to be intercepted
+         * @param[in] offset    From which length of the given path the actual path should start at present
+         * @return          Planned path as a list of connection IDs
+         */
+        edgeList intercept(const rm::Overlay &overlay, pose_id source, const edgeList &path, float offset = 0.0f) const;
+    };
+}
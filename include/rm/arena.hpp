@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file arena.hpp
+ * @brief This file is dedicated to the class Arena and to its allocator.
+ *
+ * @see rm#Arena
+ * @see rm#ArenaAllocator
+ */
+
+namespace rm
+{
+    /**
+     * @brief Bump allocator for objects that share the same lifetime. \n
+     *
+     * Memory is taken from large blocks by moving a pointer forward, and it is never given back one object at a time:
+     * all the blocks are released together when the arena is destroyed. This makes allocation cheap and keeps the objects
+     * of a graph close to each other in memory. \n
+     *
+     * When the amount of memory that will be needed is known in advance, it can be reserved so that it fits a single block.
+     *
+     * @see ArenaAllocator
+     */
+    class Arena
+    {
+    private:
+        std::vector<std::unique_ptr<char[]>> _blocks;
+        char *_head;
+        size_t _left;
+        size_t _block_size;
+        size_t _capacity;
+        size_t _used;
+
+        void addBlock(size_t size);
+
+    public:
+        /** Default size of a block, in bytes */
+        static const size_t BLOCK_SIZE = 64 * 1024;
+
+        /**
+         * @brief Construct a new Arena object.
+         *
+         * @param[in] size  Optional: size of the first block, in bytes. No memory is allocated if 0
+         */
+        explicit Arena(size_t size = 0);
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        /**
+         * @brief Allocate memory from the current block, or from a new block if it does not fit.
+         *
+         * @param[in] bytes Size of the memory to allocate
+         * @param[in] align Alignment of the memory to allocate
+         * @return      Pointer to the allocated memory
+         */
+        void *allocate(size_t bytes, size_t align);
+
+        /**
+         * @brief Make sure that the next allocations, up to the given size, are taken from the same block.
+         *
+         * @param[in] bytes Size of the memory that will be allocated
+         */
+        void reserve(size_t bytes);
+
+        /**
+         * @brief Get the size of the memory allocated so far, including the one of objects that are no longer used.
+         *
+         * @return Allocated memory, in bytes
+         */
+        size_t getUsed() const;
+
+        /**
+         * @brief Get the size of the memory held by the arena.
+         *
+         * @return Total size of the blocks, in bytes
+         */
+        size_t getCapacity() const;
+    };
+
+    /**
+     * @brief Standard allocator taking memory from an Arena. \n
+     *
+     * Deallocation does nothing: memory is released only when the arena is destroyed.
+     * Containers take their allocator along when they are moved, swapped or assigned, so that their storage always belongs to the same arena.
+     *
+     * @tparam T    Type of the allocated objects
+     *
+     * @see Arena
+     */
+    template <class T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        /** Arena the memory is taken from */
+        Arena *arena;
+
+        /**
+         * @brief Construct a new ArenaAllocator object.
+         *
+         * @param[in] arena Arena the memory is taken from
+         */
+        inline ArenaAllocator(Arena *arena) : arena(arena) {}
+
+        template <class U>
+        inline ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+        inline T *allocate(size_t n) { return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T))); }
+
+        inline void deallocate(T *, size_t) {}
+    };
+
+    template <class T, class U>
+    inline bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+
+    template <class T, class U>
+    inline bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+    /** Vector whose storage is taken from an Arena */
+    template <class T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "rm/roadmap.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file cache.hpp
+ * @brief This file is dedicated to the persistent on-disk cache of built roadmaps. \n
+ *
+ * A built RoadMap is stored in a flat binary file where every reference between nodes, poses and connections is an index.
+ * The file is identified by a hash of the arena and of the building parameters, so that a roadmap is only rebuilt when the arena changes.
+ * Coordinates are snapped to a grid before hashing, so that arenas detected with small differences share the same roadmap.
+ * Loading maps the file in memory and restores the roadmap without any collision checking.
+ * Only the most recently used files are kept in the cache folder.
+ *
+ * @see rm#hashArena()
+ * @see rm#saveRoadMap()
+ * @see rm#loadRoadMap()
+ */
+
+namespace rm
+{
+    /**
+     * @brief Compute the key identifying a roadmap built on a given arena. \n
+     *
+     * Vertices of the borders and obstacles are snapped to a grid of the given resolution, so a roadmap built on an arena is also used
+     * for arenas whose vertices moved by less than the resolution: it must be well below the inflation offset of the obstacles.
+     *
+     * @param[in] borders               Borders of the arena
+     * @param[in] obstacles             Obstacles of the arena
+     * @param[in] orientationsPerNode   Number of poses per node
+     * @param[in] kmax                  Maximum curvature of Dubins paths
+     * @param[in] offsets               Any other value the roadmap depends on, such as inflation offsets and thresholds
+     * @param[in] resolution            Optional: side of the grid coordinates are snapped to. If 0, coordinates must match exactly
+     * @return                      64-bit hash of the given values
+     */
+    uint64_t hashArena(const Polygon &borders, const std::vector<Polygon> &obstacles,
+                       unsigned int orientationsPerNode, float kmax, const std::vector<float> &offsets, float resolution = 0.0f);
+
+    /**
+     * @brief Get the path of the cache file associated to a key.
+     *
+     * @param[in] folder    Folder where cache files are stored
+     * @param[in] key       Key of the roadmap
+     * @return          Path of the cache file
+     *
+     * @see hashArena()
+     */
+    std::string getCacheFile(const std::string &folder, uint64_t key);
+
+    /**
+     * @brief Store a built roadmap to a binary file. \n
+     *
+     * Roadmaps built in lazy mode hold unchecked connections and are not stored. Invalidated connections are left out.
+     *
+     * @param[in] roadmap   Built roadmap
+     * @param[in] file      Path of the cache file
+     * @param[in] key       Key of the roadmap, stored in the file for verification
+     * @return          true if the file was written, false otherwise
+     *
+     * @see loadRoadMap()
+     */
+    bool saveRoadMap(const RoadMap &roadmap, const std::string &file, uint64_t key);
+
+    /**
+     * @brief Restore a built roadmap from a binary file. \n
+     *
+     * The file is memory-mapped and read in place. Nothing is loaded if the file is missing, corrupted or was stored with a different key.
+     *
+     * @param[out] roadmap  Out: Empty roadmap to restore the content into
+     * @param[in]  file     Path of the cache file
+     * @param[in]  key      Expected key of the roadmap
+     * @return          true if the roadmap was restored, false otherwise
+     *
+     * @see saveRoadMap()
+     */
+    bool loadRoadMap(RoadMap &roadmap, const std::string &file, uint64_t key);
+
+    /**
+     * @brief Remove the least recently used cache files of a folder, keeping at most a given number of them. \n
+     *
+     * Files are ordered by modification time, which loadRoadMap() updates on every hit.
+     *
+     * @param[in] folder    Folder where cache files are stored
+     * @param[in] count     Maximum number of cache files to keep
+     * @return          Number of removed files
+     *
+     * @see getCacheFile()
+     */
+    size_t pruneCache(const std::string &folder, size_t count);
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "rm/roadmap.hpp"
+#include "dubins/dubins.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @file frozen.hpp
+ * @brief This file is dedicated to the class FrozenRoadMap.
+ *
+ * @see rm#FrozenRoadMap
+ */
+
+namespace rm
+{
+    /**
+     * @brief Read-only, position-independent image of a built RoadMap. \n
+     *
+     * Nodes, poses and connections are stored in flat arrays inside a single contiguous buffer and refer to each other by index,
+     * so that the image holds no pointers. Poses are identified by a global ID and their outgoing and incoming connections
+     * are stored contiguously, which makes the image suitable for fast graph searches. \n
+     *
+     * An image can be created from a RoadMap in the same process, or published to a file and mapped read-only by other processes.
+     * Files in /dev/shm are held in shared memory, so every process mapping the same image shares the same physical pages.
+     *
+     * @see RoadMap#freeze()
+     * @see nav#NavMap
+     */
+    class FrozenRoadMap
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef uint32_t pose_id;
+        /** Type for the ID of a connection */
+        typedef uint32_t edge_id;
+        /** ID used for missing poses and connections */
+        static const uint32_t NONE = 0xFFFFFFFF;
+
+    private:
+        struct NodeRecord
+        {
+            float x;
+            float y;
+            pose_id first_pose;
+            uint32_t pose_count;
+        };
+
+        struct PoseRecord
+        {
+            float theta;
+            uint32_t node;
+        };
+
+        std::vector<char> _buffer;
+        void *_mapped;
+        size_t _size;
+
+        const NodeRecord *_nodes;
+        const PoseRecord *_poses;
+        const edge_id *_out_begin;
+        const uint32_t *_in_begin;
+        const pose_id *_edge_from;
+        const pose_id *_edge_to;
+        const float *_edge_length;
+        const dubins::DubinsCurve *_edge_path;
+        const edge_id *_in_edge;
+        size_t _node_count;
+        size_t _pose_count;
+        size_t _edge_count;
+
+        const RoadMap *_source;
+        std::vector<const RoadMap::DubinsConnection *> _links;
+        std::vector<size_t> _link_ids;
+        bool _lazy;
+
+        void attach(const char *data, size_t size);
+        bool isConsistent() const;
+
+    public:
+        /**
+         * @brief Create the image of a RoadMap. \n
+         *
+         * Node IDs are preserved and connections known to collide are left out. The image keeps a link to the connections of the RoadMap,
+         * which must not be modified for as long as the image is in use.
+         *
+         * @param[in] roadmap   Built RoadMap
+         */
+        explicit FrozenRoadMap(const RoadMap &roadmap);
+
+        /**
+         * @brief Map an image published by another process. The file is mapped read-only. \n
+         *
+         * Every index of the image is checked before it is used, so that a corrupted or foreign file is rejected instead of being read out of bounds.
+         *
+         * @param[in] file  Path of the image, e.g. a file in /dev/shm for a shared memory segment
+         *
+         * @see publish()
+         */
+        explicit FrozenRoadMap(const std::string &file);
+
+        FrozenRoadMap(const FrozenRoadMap &) = delete;
+        FrozenRoadMap &operator=(const FrozenRoadMap &) = delete;
+
+        /**
+         * @brief Destroy the FrozenRoadMap object, releasing the mapped image.
+         *
+         */
+        ~FrozenRoadMap();
+
+        /**
+         * @brief Write the image to a file, so that other processes can map it.
+         *
+         * @param[in] file  Path of the image, e.g. a file in /dev/shm for a shared memory segment
+         * @return      true if the image was written, false otherwise
+         */
+        bool publish(const std::string &file) const;
+
+        /**
+         * @brief Get the RoadMap this image was created from.
+         *
+         * @return Pointer to the source RoadMap, nullptr for mapped images
+         */
+        const RoadMap *getRoadMap() const;
+
+        /**
+         * @brief Get the RoadMap connection associated to a connection of the image.
+         *
+         * @param[in] edge  Connection ID
+         * @return      Pointer to the RoadMap connection, nullptr for mapped images
+         */
+        const RoadMap::DubinsConnection *getConnection(edge_id edge) const;
+
+        /**
+         * @brief Get the global ID of a pose of the source RoadMap.
+         *
+         * @param[in] pose  Pose of the source RoadMap
+         * @return      Global ID of the pose
+         */
+        pose_id getPoseID(const RoadMap::Node::Orientation &pose) const;
+
+        /** @brief Number of positional nodes. */
+        inline size_t getNodeCount() const { return _node_count; }
+        /** @brief Number of poses. */
+        inline size_t getPoseCount() const { return _pose_count; }
+        /** @brief Number of connections. */
+        inline size_t getEdgeCount() const { return _edge_count; }
+
+        /** @brief x-coordinate of a node. */
+        inline float getX(RoadMap::node_id node) const { return _nodes[node].x; }
+        /** @brief y-coordinate of a node. */
+        inline float getY(RoadMap::node_id node) const { return _nodes[node].y; }
+        /** @brief Global ID of the first pose of a node. Poses of a node have consecutive IDs. */
+        inline pose_id getFirstPose(RoadMap::node_id node) const { return _nodes[node].first_pose; }
+        /** @brief Number of poses of a node. */
+        inline size_t getPosesCount(RoadMap::node_id node) const { return _nodes[node].pose_count; }
+
+        /** @brief Node a pose belongs to. */
+        inline RoadMap::node_id getNode(pose_id pose) const { return _poses[pose].node; }
+        /** @brief Angle of a pose with respect to the x-axis, measured counter-clockwise. */
+        inline float getTheta(pose_id pose) const { return _poses[pose].theta; }
+
+        /** @brief First connection starting from a pose. Connections starting from a pose have consecutive IDs. */
+        inline edge_id getOutBegin(pose_id pose) const { return _out_begin[pose]; }
+        /** @brief One past the last connection starting from a pose. */
+        inline edge_id getOutEnd(pose_id pose) const { return _out_begin[pose + 1]; }
+        /** @brief First index of the connections leading to a pose. */
+        inline uint32_t getInBegin(pose_id pose) const { return _in_begin[pose]; }
+        /** @brief One past the last index of the connections leading to a pose. */
+        inline uint32_t getInEnd(pose_id pose) const { return _in_begin[pose + 1]; }
+        /** @brief Connection leading to a pose, by its index. */
+        inline edge_id getInEdge(uint32_t index) const { return _in_edge[index]; }
+
+        /** @brief Starting pose of a connection. */
+        inline pose_id getFrom(edge_id edge) const { return _edge_from[edge]; }
+        /** @brief Destination pose of a connection. */
+        inline pose_id getTo(edge_id edge) const { return _edge_to[edge]; }
+        /** @brief Length of a connection. */
+        inline float getLength(edge_id edge) const { return _edge_length[edge]; }
+        /** @brief Dubins path of a connection. */
+        inline const dubins::DubinsCurve &getPath(edge_id edge) const { return _edge_path[edge]; }
+
+        /**
+         * @brief Check whether a connection can be followed. \n
+         *
+         * Connections of lazily built roadmaps are skipped once they are found invalid. Connections of mapped images are always usable.
+         *
+         * @param[in] edge  Connection ID
+         * @return      false if the connection is known to collide, true otherwise
+         */
+        inline bool isUsable(edge_id edge) const
+        {
+            return !_lazy || _source->getState(_link_ids[edge]) != RoadMap::INVALID;
+        }
+    };
+}
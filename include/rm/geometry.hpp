@@ -116,6 +116,36 @@ namespace rm
      */
     bool collisionCheck(const dubins::DubinsCurve &curve, const Polygon &p);
 
+    /**
+     * @brief       Check collision between a Dubins curve, a set of obstacles and the borders of the arena.
+     * 
+     * @param[in] curve     Dubins curve
+     * @param[in] obstacles Obstacles
+     * @param[in] borders   Borders of the arena. No check is performed against empty borders
+     * @return          true if a collision was detected, false otherwise.
+     * 
+     * @see dubins#DubinsCurve
+     */
+    bool collisionCheck(const dubins::DubinsCurve &curve, const std::vector<Polygon> &obstacles, const Polygon &borders);
+
+    /**
+     * @brief Compute the distance between a point and a segment.
+     *
+     * @param[in] p Point
+     * @param[in] s Segment
+     * @return  Euclidean distance from the point to the closest point of the segment
+     */
+    float distance(const Point &p, const Segment &s);
+
+    /**
+     * @brief Compute the distance between a point and the boundary of a polygon.
+     *
+     * @param[in] p     Point
+     * @param[in] poly  Polygon
+     * @return      Euclidean distance from the point to the closest edge of the polygon
+     */
+    float distance(const Point &p, const Polygon &poly);
+
     /**
      * @brief Convert a vertex-list polygon to an edge-list polygon.
      * 
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "rm/roadmap.hpp"
+#include "dubins/dubins.hpp"
+#include "utils.hpp"
+
+#include <utility>
+#include <vector>
+
+/**
+ * @file lattice.hpp
+ * @brief This file is dedicated to the construction of roadmaps as state lattices, an alternative to the visibility graph.
+ *
+ * @see rm#MotionPrimitives
+ * @see rm#buildLattice()
+ */
+
+namespace rm
+{
+    /**
+     * @brief Library of Dubins motion primitives joining the states of a lattice. \n
+     *
+     * The lattice is a grid of positions, with the given spacing, each one holding a set of evenly spaced headings.
+     * Primitives start from the origin and reach the states within a number of grid steps, so that they hold for any node of the lattice
+     * after a translation. Each primitive stores the cells of the occupancy grid swept by its path, which is the only data needed to check it
+     * against the obstacles. \n
+     *
+     * Swept cells are found by sampling the path every quarter of a cell. A cell counts as occupied when an obstacle lies within a cell
+     * from its centre, so that any point of the path inside an obstacle is detected by the cell of its closest sample.
+     *
+     * @see buildLattice()
+     */
+    class MotionPrimitives
+    {
+    public:
+        /**
+         * @brief Motion primitive starting from the origin.
+         */
+        struct Primitive
+        {
+            /** Grid steps along the x-axis. */
+            int dx;
+            /** Grid steps along the y-axis. */
+            int dy;
+            /** Index of the final heading. */
+            unsigned int heading;
+            /** Dubins path from the origin. */
+            dubins::DubinsCurve path;
+            /** Cells swept by the path, relative to the cell of the origin. */
+            std::vector<std::pair<int, int>> footprint;
+        };
+
+    private:
+        float _spacing;
+        unsigned int _resolution;
+        std::vector<std::vector<Primitive>> _primitives;
+
+    public:
+        /**
+         * @brief Compute the library of primitives.
+         *
+         * @param[in] spacing       Distance between two neighbouring positions of the lattice
+         * @param[in] headings      Number of headings of each position
+         * @param[in] reach         Maximum distance of the final position, in grid steps
+         * @param[in] kmax          Maximum curvature of Dubins paths
+         * @param[in] resolution    Number of occupancy cells along each grid step
+         * @param[in] maxDetour     Maximum difference between the length of a primitive and the distance it covers.
+         *                          Longer primitives, which make loops to change their heading, are left out
+         */
+        MotionPrimitives(float spacing, unsigned int headings, unsigned int reach, float kmax, unsigned int resolution, float maxDetour);
+
+        /** @brief Distance between two neighbouring positions of the lattice. */
+        inline float getSpacing() const { return _spacing; }
+
+        /** @brief Side of the occupancy cells. */
+        inline float getCellSize() const { return _spacing / _resolution; }
+
+        /** @brief Number of occupancy cells along each grid step. */
+        inline unsigned int getResolution() const { return _resolution; }
+
+        /** @brief Number of headings of each position. */
+        inline unsigned int getHeadingCount() const { return _primitives.size(); }
+
+        /** @brief Value of a heading. */
+        float getHeading(unsigned int heading) const;
+
+        /**
+         * @brief Get the primitives starting from a heading.
+         *
+         * @param[in] heading   Index of the initial heading
+         * @return          Primitives starting from the origin with the given heading
+         */
+        const std::vector<Primitive> &getPrimitives(unsigned int heading) const;
+
+        /** @brief Total number of primitives. */
+        size_t getPrimitiveCount() const;
+    };
+
+    /**
+     * @brief Build a roadmap as a state lattice over the arena. \n
+     *
+     * Obstacles and borders are rasterized once into an occupancy grid, aligned to the lattice. Each free position of the lattice becomes
+     * a node with a pose for each heading, and each primitive is added as a connection when none of the cells it sweeps is occupied,
+     * with no Dubins path being computed nor collision checked. \n
+     *
+     * Start and goal poses are connected as for the other roadmaps, and the result can be frozen, searched and cached in the same way.
+     * As for roadmaps loaded from the cache, it cannot be updated with RoadMap#update().
+     *
+     * @param[out] roadmap      Out: empty roadmap where the result is stored
+     * @param[in]  primitives   Library of motion primitives
+     * @param[in]  obstacles    Inflated obstacles
+     * @param[in]  borders      Inflated borders
+     * @return              Number of connections that are created in the process
+     *
+     * @see MotionPrimitives
+     */
+    unsigned long buildLattice(RoadMap &roadmap, const MotionPrimitives &primitives, const std::vector<Polygon> &obstacles, const Polygon &borders);
+}
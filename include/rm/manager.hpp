@@ -0,0 +1,125 @@
+#pragma once
+
+#include "rm/roadmap.hpp"
+#include "rm/frozen.hpp"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+
+/**
+ * @file manager.hpp
+ * @brief This file is dedicated to the class RoadMapManager.
+ *
+ * @see rm#RoadMapManager
+ */
+
+namespace rm
+{
+    /**
+     * @brief Double-buffered owner of the roadmap used for planning. \n
+     *
+     * Queries are served from the current roadmap, which is immutable once published, while the next one is built by a background thread.
+     * When the new roadmap is ready, it replaces the current one with an atomic swap. Readers that still hold the previous roadmap
+     * keep it alive until they release it. \n
+     *
+     * Published roadmaps are frozen before the swap, so that navigation maps can be created from any thread.
+     * Roadmaps built in lazy mode cache the collision state of their connections on demand and should not be queried by more than one thread.
+     *
+     * @see RoadMap
+     * @see FrozenRoadMap
+     */
+    class RoadMapManager
+    {
+    public:
+        /** Function filling an empty RoadMap, e.g. by computing the visibility graph and building it */
+        typedef std::function<void(RoadMap &)> Builder;
+
+    private:
+        std::shared_ptr<const RoadMap> _current;
+        std::atomic<unsigned long> _version;
+        std::atomic<bool> _building;
+        std::thread _worker;
+        std::exception_ptr _error;
+
+        void run(Builder builder);
+
+    public:
+        /**
+         * @brief Construct a new RoadMapManager object with no roadmap.
+         *
+         */
+        RoadMapManager();
+
+        RoadMapManager(const RoadMapManager &) = delete;
+        RoadMapManager &operator=(const RoadMapManager &) = delete;
+
+        /**
+         * @brief Destroy the RoadMapManager object, waiting for the running build to terminate.
+         *
+         */
+        ~RoadMapManager();
+
+        /**
+         * @brief Start building a new roadmap in a background thread. \n
+         *
+         * The current roadmap is still served during the build and it is replaced only if the build succeeds.
+         *
+         * @param[in] builder   Function filling the new roadmap
+         * @return          true if the build was started, false if another build is running
+         *
+         * @see wait()
+         */
+        bool rebuild(Builder builder);
+
+        /**
+         * @brief Publish a roadmap built by the caller, replacing the current one.
+         *
+         * @param[in] roadmap   Built roadmap. It must not be modified after being published
+         */
+        void publish(std::shared_ptr<RoadMap> roadmap);
+
+        /**
+         * @brief Wait for the running build to terminate. \n
+         *
+         * Exceptions raised by the builder are forwarded to the caller.
+         * This method and rebuild() are meant to be called by the thread owning the manager.
+         *
+         */
+        void wait();
+
+        /**
+         * @brief Return true if a build is running in background.
+         *
+         * @return true if a build is running, false otherwise
+         */
+        bool isBuilding() const;
+
+        /**
+         * @brief Get the number of roadmaps published so far.
+         *
+         * @return Version of the current roadmap, 0 if no roadmap was published
+         */
+        unsigned long getVersion() const;
+
+        /**
+         * @brief Get the current roadmap. Safe to call from any thread.
+         *
+         * @return Shared pointer to the current roadmap, nullptr if no roadmap was published
+         */
+        std::shared_ptr<const RoadMap> getRoadMap() const;
+
+        /**
+         * @brief Get the frozen image of the current roadmap. Safe to call from any thread. \n
+         *
+         * The returned pointer also keeps the roadmap alive, so that it can be handed to a navigation map.
+         *
+         * @return Shared pointer to the image of the current roadmap, nullptr if no roadmap was published
+         *
+         * @see nav#NavMap
+         */
+        std::shared_ptr<const FrozenRoadMap> getGraph() const;
+    };
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "rm/frozen.hpp"
+#include "dubins/dubins.hpp"
+#include "utils.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @file overlay.hpp
+ * @brief This file is dedicated to the class Overlay.
+ *
+ * @see rm#Overlay
+ */
+
+namespace rm
+{
+    /**
+     * @brief Query-local extension of a FrozenRoadMap with start and goal poses. \n
+     *
+     * The overlay stores the poses and connections that are specific to a query, such as the starting poses of the robots
+     * and the poses of the gates, without modifying the base roadmap. Several queries can therefore share the same roadmap,
+     * even from different threads, unless it was built in lazy mode: validating a connection caches its state in the shared RoadMap. \n
+     *
+     * Poses, nodes and connections of the overlay are numbered after the ones of the base roadmap, so that IDs of the base roadmap
+     * are valid in the overlay as well. Every overlay pose lies on its own node, which can be connected to the ones added before it.
+     *
+     * @see FrozenRoadMap
+     * @see nav#NavMap
+     */
+    class Overlay
+    {
+    public:
+        /** Type for the global ID of a pose */
+        typedef FrozenRoadMap::pose_id pose_id;
+        /** Type for the ID of a connection */
+        typedef FrozenRoadMap::edge_id edge_id;
+
+    private:
+        struct PoseRecord
+        {
+            float x;
+            float y;
+            float theta;
+        };
+
+        struct EdgeRecord
+        {
+            pose_id from;
+            pose_id to;
+            dubins::DubinsCurve path;
+        };
+
+        std::shared_ptr<const FrozenRoadMap> _base;
+        std::vector<PoseRecord> _poses;
+        std::vector<EdgeRecord> _edges;
+        // Connections of the overlay touching poses of the base roadmap, sorted by pose. Searches ask for every pose they expand,
+        // so a bit per pose of the base roadmap tells the few poses that have any
+        struct BaseEdges
+        {
+            pose_id pose;
+            std::vector<edge_id> edges;
+        };
+
+        std::vector<std::vector<edge_id>> _out;
+        std::vector<std::vector<edge_id>> _in;
+        std::vector<BaseEdges> _base_out;
+        std::vector<BaseEdges> _base_in;
+        std::vector<uint64_t> _base_out_mask;
+        std::vector<uint64_t> _base_in_mask;
+
+        static const std::vector<edge_id> NO_EDGES;
+
+        pose_id addPose(Point pos, float angle);
+        edge_id addEdge(pose_id from, pose_id to, const dubins::DubinsCurve &path);
+        void link(edge_id edge);
+        static void linkBase(std::vector<BaseEdges> &edges, std::vector<uint64_t> &mask, pose_id pose, edge_id edge);
+        static const std::vector<edge_id> &findBase(const std::vector<BaseEdges> &edges, pose_id pose);
+        static inline bool isMarked(const std::vector<uint64_t> &mask, pose_id pose) { return (mask[pose >> 6] >> (pose & 63)) & 1; }
+        std::vector<RoadMap::node_id> findKClosest(Point pos, int k, RoadMap::node_id skip) const;
+
+    public:
+        /**
+         * @brief Construct an empty overlay on top of a roadmap.
+         *
+         * @param[in] base  Frozen image of the base roadmap
+         */
+        explicit Overlay(std::shared_ptr<const FrozenRoadMap> base);
+
+        /**
+         * @brief Add a pose for the starting point of a robot, connected to the poses of the closest nodes.
+         *
+         * @param[in] pos       Position of the start point
+         * @param[in] angle     Angle of the start pose with respect to the x-axis, measured counter-clockwise
+         * @param[in] k         Number of closest nodes the start pose should be connected to
+         * @param[in] kmax      Maximum curvature of dubins paths
+         * @param[in] obstacles Obstacles for collision checking
+         * @param[in] borders   Borders for collision checking
+         * @return          Global ID of the created pose
+         */
+        pose_id addStartPose(Point pos, float angle, int k, float kmax, const std::vector<Polygon> &obstacles, const Polygon &borders);
+
+        /**
+         * @brief Add a pose for the goal point of a robot, connected from the poses of the closest nodes.
+         *
+         * @param[in] pos       Position of the goal point
+         * @param[in] angle     Angle of the goal pose with respect to the x-axis, measured counter-clockwise
+         * @param[in] k         Number of closest nodes the goal pose should be connected from
+         * @param[in] kmax      Maximum curvature of dubins paths
+         * @param[in] obstacles Obstacles for collision checking
+         * @param[in] borders   Borders for collision checking
+         * @return          Global ID of the created pose
+         */
+        pose_id addGoalPose(Point pos, float angle, int k, float kmax, const std::vector<Polygon> &obstacles, const Polygon &borders);
+
+        /**
+         * @brief Add a connection that keeps a robot still on a pose for a given time. \n
+         *
+         * Wait connections start and end on the same pose and are not followed by graph searches.
+         *
+         * @param[in] pose      Global ID of the pose
+         * @param[in] length    Length of the path the robot could cover while waiting
+         * @return          ID of the created connection
+         *
+         * @see isWait()
+         */
+        edge_id addWait(pose_id pose, float length);
+
+        /**
+         * @brief Add a connection that follows a given path from a pose. \n
+         *
+         * Like wait connections, such connections are not followed by graph searches: they hold paths computed after a search,
+         * such as refined ones.
+         *
+         * @param[in] from      Global ID of the starting pose
+         * @param[in] path      Dubins path leaving the starting pose
+         * @param[in] to        Optional: global ID of the destination pose. If not given, a new pose is created at the end of the path
+         * @return          ID of the created connection
+         *
+         * @see nav#refinePath()
+         */
+        edge_id addPath(pose_id from, const dubins::DubinsCurve &path, pose_id to = FrozenRoadMap::NONE);
+
+        /**
+         * @brief Get the base roadmap.
+         *
+         * @return Frozen image of the base roadmap
+         */
+        const FrozenRoadMap &getBase() const;
+
+        /** @brief Number of positional nodes, including the ones of the base roadmap. */
+        inline size_t getNodeCount() const { return _base->getNodeCount() + _poses.size(); }
+        /** @brief Number of poses, including the ones of the base roadmap. */
+        inline size_t getPoseCount() const { return _base->getPoseCount() + _poses.size(); }
+        /** @brief Number of connections, including the ones of the base roadmap. */
+        inline size_t getEdgeCount() const { return _base->getEdgeCount() + _edges.size(); }
+
+        /** @brief Return true if the pose belongs to the overlay. */
+        inline bool isOverlay(pose_id pose) const { return pose >= _base->getPoseCount(); }
+        /** @brief Return true if the connection belongs to the overlay. */
+        inline bool isOverlayEdge(edge_id edge) const { return edge >= _base->getEdgeCount(); }
+        /** @brief Return true if the connection is a wait connection. */
+        inline bool isWait(edge_id edge) const { return isOverlayEdge(edge) && getFrom(edge) == getTo(edge); }
+
+        /** @brief First pose of a node. Poses of a node have consecutive IDs. */
+        inline pose_id getFirstPose(RoadMap::node_id node) const
+        {
+            return node < _base->getNodeCount() ? _base->getFirstPose(node) : _base->getPoseCount() + (node - _base->getNodeCount());
+        }
+        /** @brief Number of poses of a node. */
+        inline size_t getPosesCount(RoadMap::node_id node) const
+        {
+            return node < _base->getNodeCount() ? _base->getPosesCount(node) : 1;
+        }
+        /** @brief Node a pose belongs to. */
+        inline RoadMap::node_id getNode(pose_id pose) const
+        {
+            return isOverlay(pose) ? _base->getNodeCount() + (pose - _base->getPoseCount()) : _base->getNode(pose);
+        }
+        /** @brief x-coordinate of a pose. */
+        inline float getX(pose_id pose) const
+        {
+            return isOverlay(pose) ? _poses[pose - _base->getPoseCount()].x : _base->getX(_base->getNode(pose));
+        }
+        /** @brief y-coordinate of a pose. */
+        inline float getY(pose_id pose) const
+        {
+            return isOverlay(pose) ? _poses[pose - _base->getPoseCount()].y : _base->getY(_base->getNode(pose));
+        }
+        /** @brief Angle of a pose with respect to the x-axis, measured counter-clockwise. */
+        inline float getTheta(pose_id pose) const
+        {
+            return isOverlay(pose) ? _poses[pose - _base->getPoseCount()].theta : _base->getTheta(pose);
+        }
+
+        /** @brief Connections of the overlay starting from a pose. Connections of the base roadmap are not included. */
+        inline const std::vector<edge_id> &getOutEdges(pose_id pose) const
+        {
+            if (isOverlay(pose))
+                return _out[pose - _base->getPoseCount()];
+            return isMarked(_base_out_mask, pose) ? findBase(_base_out, pose) : NO_EDGES;
+        }
+        /** @brief Connections of the overlay leading to a pose. Connections of the base roadmap are not included. */
+        inline const std::vector<edge_id> &getInEdges(pose_id pose) const
+        {
+            if (isOverlay(pose))
+                return _in[pose - _base->getPoseCount()];
+            return isMarked(_base_in_mask, pose) ? findBase(_base_in, pose) : NO_EDGES;
+        }
+
+        /** @brief Starting pose of a connection. */
+        inline pose_id getFrom(edge_id edge) const
+        {
+            return isOverlayEdge(edge) ? _edges[edge - _base->getEdgeCount()].from : _base->getFrom(edge);
+        }
+        /** @brief Destination pose of a connection. */
+        inline pose_id getTo(edge_id edge) const
+        {
+            return isOverlayEdge(edge) ? _edges[edge - _base->getEdgeCount()].to : _base->getTo(edge);
+        }
+        /** @brief Length of a connection. */
+        inline float getLength(edge_id edge) const
+        {
+            return isOverlayEdge(edge) ? _edges[edge - _base->getEdgeCount()].path.L : _base->getLength(edge);
+        }
+        /** @brief Dubins path of a connection. */
+        inline const dubins::DubinsCurve &getPath(edge_id edge) const
+        {
+            return isOverlayEdge(edge) ? _edges[edge - _base->getEdgeCount()].path : _base->getPath(edge);
+        }
+    };
+}
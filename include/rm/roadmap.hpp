@@ -1,9 +1,12 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <mutex>
 
 #include "utils.hpp"
 #include "dubins/dubins.hpp"
+#include "rm/arena.hpp"
 
 /**
  * @file RoadMap.hpp
@@ -19,6 +22,8 @@
  */
 namespace rm
 {
+    class FrozenRoadMap;
+
     /**
      * @brief Roadmap for navigation in a 2-dimensional space. \n 
      * 
@@ -55,10 +60,13 @@ namespace rm
             private:
                 float _theta;
                 Node *_parent;
-                std::vector<rm::RoadMap::DubinsConnection> _connections;
-                std::vector<rm::RoadMap::DubinsConnection> _from;
+                ArenaVector<rm::RoadMap::DubinsConnection> _connections;
+                ArenaVector<rm::RoadMap::DubinsConnection> _from;
                 size_t _id;
 
+                friend class Node;
+                friend class RoadMap;
+
             public:
                 /**
                  * @brief Construct a new Orientation object.
@@ -80,6 +88,35 @@ namespace rm
                  */
                 bool connect(Orientation &other, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders);
 
+                /**
+                 * @brief Build a connection between two poses with the shortest Dubins path, without collision checking. \n
+                 *
+                 * The connection is stored as unchecked and must be validated before being followed.
+                 *
+                 * @param[in] other     Pose to connect to
+                 * @param[in] kmax      Maximum curvature of Dubins curves
+                 * @return          true if a Dubins path was found, false otherwise
+                 *
+                 * @see RoadMap#validate()
+                 */
+                bool connectUnchecked(Orientation &other, float const &kmax);
+
+                /**
+                 * @brief Store a collision free connection between two poses with a pre-computed Dubins path.
+                 *
+                 * @param[in] other     Pose to connect to
+                 * @param[in] path      Dubins path that connects this pose to the other pose
+                 */
+                void addConnection(Orientation &other, const dubins::DubinsCurve &path);
+
+                /**
+                 * @brief Reserve storage for the connections of this pose, so that it is allocated only once.
+                 *
+                 * @param[in] connections   Expected number of connections starting from this pose
+                 * @param[in] from          Expected number of connections leading to this pose
+                 */
+                void reserve(size_t connections, size_t from);
+
                 /**
                  * @brief   Get the value of the angle.
                  * 
@@ -151,8 +188,10 @@ namespace rm
             RoadMap *_parent;
             node_id _id;
             Point _pos;
-            std::vector<Orientation> _poses;
-            std::vector<node_id> _connected;
+            ArenaVector<Orientation> _poses;
+            ArenaVector<node_id> _connected;
+
+            friend class RoadMap;
 
         public:
             /**
@@ -164,6 +203,25 @@ namespace rm
              */
             Node(RoadMap *parent, node_id id, Point pos);
 
+            /**
+             * @brief Move a Node object, e.g. when the node list grows. Its poses are not moved and are given the new parent.
+             *
+             * @param[in] other Node object to be moved
+             */
+            Node(Node &&other) noexcept;
+
+            // Copies would keep poses whose parent is the copied node
+            Node(const Node &other) = delete;
+            Node &operator=(const Node &other) = delete;
+
+            /**
+             * @brief Move a Node object. Its poses are not moved and are given the new parent.
+             *
+             * @param[in] other Node object to be moved
+             * @return      Reference to this Node object
+             */
+            Node &operator=(Node &&other) noexcept;
+
             /**
              * @brief Get x-coordinate of the node.
              * 
@@ -223,6 +281,14 @@ namespace rm
              */
             Node &getConnected(size_t index);
 
+            /**
+             * @brief Get a connected node by its index.
+             *
+             * @param[in] index Index of the connected node in the connection list
+             * @return Read-only reference to the Node object at given index in the connection list
+             */
+            const Node &getConnected(size_t index) const;
+
             /**
              * @brief Remove all the stored poses of the Node object.
              * 
@@ -252,6 +318,22 @@ namespace rm
              */
             bool connectTo(node_id to);
 
+            /**
+             * @brief Check whether this Node object is connected to another Node object in the base directed graph of the RoadMap.
+             *
+             * @param[in] to    ID of the other Node object
+             * @return      true if the connection exists, false otherwise
+             */
+            bool isConnectedTo(node_id to) const;
+
+            /**
+             * @brief Remove the connection from this Node object to another Node object in the base directed graph of the RoadMap.
+             *
+             * @param[in] to    ID of the Node object this node should be disconnected from
+             * @return      true if an edge was removed, false otherwise
+             */
+            bool disconnectFrom(node_id to);
+
             operator node_id() const;
         }; // Node
 
@@ -269,22 +351,67 @@ namespace rm
             Node::Orientation *to;
             /** Dubins path that connects the starting pose to the destination pose */
             dubins::DubinsCurve path;
+            /** Index of the connection in the state table of the RoadMap. Connections not owned by a RoadMap use -1 */
+            size_t id;
 
             /**
              * @brief Construct a new DubinsConnection object
-             * 
+             *
              * @param[in] from  Pointer to the starting pose
              * @param[in] to    Pointer to the destination pose
              * @param[in] path  Dubins path that connects the starting pose to the destination pose
+             * @param[in] id    Optional: index of the connection in the state table of the RoadMap
              */
             inline DubinsConnection(Node::Orientation *from, Node::Orientation *to,
-                                    dubins::DubinsCurve path) : from(from), to(to), path(path) {}
+                                    dubins::DubinsCurve path, size_t id = -1) : from(from), to(to), path(path), id(id) {}
         }; // DubinsConnection
 
+        /**
+         * @brief Collision state of a connection.
+         *
+         * @see RoadMap#validate()
+         */
+        enum ConnectionState : unsigned char
+        {
+            /** The connection was not collision checked yet */
+            UNCHECKED,
+            /** The connection is collision free */
+            VALID,
+            /** The connection collides with obstacles or borders */
+            INVALID
+        };
+
     private:
-        std::vector<Node> _nodes;
+        // Declared first, so that it is released after the nodes
+        std::unique_ptr<Arena> _arena;
+        ArenaVector<Node> _nodes;
+        mutable ArenaVector<ConnectionState> _states;
+        bool _lazy = false;
+        unsigned int _orientations = 0;
+        unsigned int _min_orientations = 0;
+        float _kmax = 0.0f;
+        std::vector<Polygon> _obstacles;
+        Polygon _borders;
+        mutable std::shared_ptr<const FrozenRoadMap> _frozen;
+        mutable std::mutex _frozen_mutex;
+
+        size_t addConnectionState(ConnectionState state);
+        void touch();
+        void compact();
+        std::vector<float> makeHeadings(const Node &node) const;
+        bool isBuilt(const Node &node) const;
+        unsigned long buildGraph();
 
     public:
+        /**
+         * @brief Construct an empty RoadMap object. \n
+         *
+         * Nodes, poses and connections are stored in an Arena owned by the roadmap, which is released in one step when the roadmap is destroyed.
+         *
+         * @see Arena
+         */
+        RoadMap();
+
         /**
          * @brief Add a positional node to the RoadMap.
          * 
@@ -303,6 +430,8 @@ namespace rm
          * @param[in] obstacles Obstacles for collision checking
          * @param[in] borders   Borders for collision checking
          * @return          Reference to the created pose
+         *
+         * @see Overlay#addStartPose() to add the pose to a single query without modifying the roadmap
          */
         Node::Orientation &addStartPose(Point pos, float angle, int k, float kmax, const std::vector<Polygon> &obstacles, const Polygon &borders);
 
@@ -316,6 +445,8 @@ namespace rm
          * @param[in] obstacles Obstacles for collision checking
          * @param[in] borders   Borders for collision checking
          * @return          Reference to the created pose
+         *
+         * @see Overlay#addGoalPose() to add the pose to a single query without modifying the roadmap
          */
         Node::Orientation &addGoalPose(Point pos, float angle, int k, float kmax, const std::vector<Polygon> &obstacles, const Polygon &borders);
 
@@ -335,15 +466,140 @@ namespace rm
          * Following the base directed graph of the roadmap, for each couple of connected nodes the algorithm tries to generate
          * Dubins paths that connect each pose of the starting node to each pose of the destination node. In this phase, it is
          * checked whether the path leads to collision with obtacles or with the arena borders. The feasible paths are added to
-         * the navigation graph, which can be explored by checking the connections of each pose.
-         * 
+         * the navigation graph, which can be explored by checking the connections of each pose. \n
+         *
+         * In lazy mode, only the shortest Dubins path of each couple of poses is stored and no collision check is performed.
+         * Obstacles and borders are kept by the roadmap, so that connections can be validated on demand when a search reaches them. \n
+         *
+         * The storage needed by poses and connections is counted before they are created and it is allocated at once from a new Arena,
+         * which replaces the one of the previous build.
+         *
          * @param[in] orientationsPerNode   Number of poses to be created on each positional node
          * @param[in] kmax                  Maximum curvature of Dubins paths
          * @param[in] obstacles             Obstacles to check collision against when computing Dubins paths
          * @param[in] borders               Borders of the arena to check collision against when computing Dubins paths
+         * @param[in] lazy                  Optional: whether collision checking should be deferred to query time
          * @return                      Number of Dubins paths that are created in the process
+         *
+         * @see RoadMap#validate()
+         */
+        unsigned long build(unsigned int orientationsPerNode, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders, bool lazy = false);
+
+        /**
+         * @brief Build the roadmap choosing the poses of each positional node from the local geometry. \n
+         *
+         * The candidate headings of a node are the directions of its visibility edges, both leaving and arriving, so that the robot can drive
+         * straight along them. Candidates closer than an angular resolution are merged into the heading in their middle. The resolution depends
+         * on the clearance of the node: close to obstacles, where there is no room to correct the heading, only almost parallel directions are merged,
+         * while in open space a few headings are enough. Nodes get at least minOrientations and at most maxOrientations poses. \n
+         *
+         * Connections are then generated as in build(), whose work grows with the product of the numbers of poses of connected nodes.
+         *
+         * @param[in] minOrientations   Minimum number of poses of a node, at least 2
+         * @param[in] maxOrientations   Maximum number of poses of a node
+         * @param[in] kmax              Maximum curvature of Dubins paths
+         * @param[in] obstacles         Obstacles to check collision against when computing Dubins paths
+         * @param[in] borders           Borders of the arena to check collision against when computing Dubins paths
+         * @param[in] lazy              Optional: whether collision checking should be deferred to query time
+         * @return                  Number of Dubins paths that are created in the process
+         *
+         * @see build()
+         */
+        unsigned long buildAdaptive(unsigned int minOrientations, unsigned int maxOrientations, float const &kmax,
+                                    const std::vector<Polygon> &obstacles, const Polygon &borders, bool lazy = false);
+
+        /**
+         * @brief Update a built roadmap after a change of the obstacles. \n
+         *
+         * Only the part of the roadmap around the changed obstacles is processed. Visibility edges and connections that collide with
+         * the added obstacles are invalidated, while visibility edges and Dubins paths that were blocked by the removed obstacles are tried again.
+         * New vertices are connected to every visible node and receive their poses as the nodes created by build() or buildAdaptive(). \n
+         *
+         * Invalidated connections are marked with the INVALID state. New connections are added to the lists of their poses, and the roadmap
+         * is moved to a new Arena when most of its storage is taken by the lists left behind, dropping the invalid connections unless it was built
+         * in lazy mode. As after build(), references to poses and connections, navigation lists and frozen images taken before the update
+         * are invalid, and the roadmap must be frozen again. Roadmaps published to a RoadMapManager must not be updated.
+         * As for build(), start and goal poses should be added after the update.
+         *
+         * @param[in] added     Obstacles added to the arena, inflated as the ones given to build()
+         * @param[in] removed   Obstacles removed from the arena, exactly as they were given to build() or to a previous update
+         * @param[in] vertices  Optional: new vertices of the visibility graph, e.g. around the added obstacles
+         * @return          Number of Dubins paths that are created in the process
+         *
+         * @see build()
+         * @see makeVisibilityNodes()
+         */
+        unsigned long update(const std::vector<Polygon> &added, const std::vector<Polygon> &removed,
+                             const std::vector<Point> &vertices = std::vector<Point>());
+
+        /**
+         * @brief Remove the connections that are never needed by a shortest path. \n
+         *
+         * A connection is dominated when a route through other poses joins the same poses and is not longer. Routes are found by a search
+         * from each pose, bounded by the length of its longest connection. Dominated connections can be removed without changing
+         * the length of any shortest path, since the connections of the route are strictly shorter and are themselves either kept
+         * or dominated in turn. \n
+         *
+         * Only valid connections are considered, as the route must be known to be collision free: in lazy mode,
+         * connections are pruned once they have been checked. Removed connections are kept with the INVALID state, as in update().
+         * An update() adding obstacles does not restore the connections that were dominated by the invalidated ones.
+         *
+         * @return Number of removed connections
+         *
+         * @see build()
+         * @see update()
+         */
+        unsigned long prune();
+
+        /**
+         * @brief Return true if the roadmap was built in lazy mode.
+         *
+         * @return true if collision checking of connections is deferred to query time
+         *
+         * @see build()
+         */
+        bool isLazy() const;
+
+        /**
+         * @brief Get the cached collision state of a connection.
+         *
+         * @param[in] connection    Connection
+         * @return              Collision state of the connection. Connections not owned by the roadmap are always valid
+         */
+        ConnectionState getState(const DubinsConnection &connection) const;
+
+        /**
+         * @brief Get the cached collision state of a connection by its index in the state table.
+         *
+         * @param[in] id    Index of the connection in the state table
+         * @return      Collision state of the connection. Connections not owned by the roadmap are always valid
+         *
+         * @see DubinsConnection#id
+         */
+        ConnectionState getState(size_t id) const;
+
+        /**
+         * @brief Collision check an unchecked connection and cache the result. \n
+         *
+         * Connections that were already checked are not evaluated again.
+         *
+         * @param[in] connection    Connection to be validated
+         * @return              true if the connection is collision free, false otherwise
+         *
+         * @see build()
+         */
+        bool validate(const DubinsConnection &connection) const;
+
+        /**
+         * @brief Get the read-only image of the roadmap used for navigation. \n
+         *
+         * The image is created on the first call and shared by every following call, until the roadmap is modified.
+         *
+         * @return Frozen image of the roadmap
+         *
+         * @see FrozenRoadMap
          */
-        unsigned long build(unsigned int orientationsPerNode, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders);
+        std::shared_ptr<const FrozenRoadMap> freeze() const;
 
         /**
          * @brief Get the number of positional nodes in this RoadMap.
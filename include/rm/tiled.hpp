@@ -0,0 +1,50 @@
+#pragma once
+
+#include "rm/roadmap.hpp"
+#include "utils.hpp"
+
+#include <vector>
+
+/**
+ * @file tiled.hpp
+ * @brief This file is dedicated to the construction of roadmaps on large arenas, split into tiles built in parallel.
+ *
+ * @see rm#buildTiled()
+ */
+
+namespace rm
+{
+    /**
+     * @brief Build a roadmap on a large arena by splitting it into a grid of tiles that are processed in parallel. \n
+     *
+     * Each tile selects the vertices of the visibility graph inside it, then computes the visibility edges and the Dubins connections
+     * of its vertices, using only the obstacles around it. Vertices of the neighbouring tiles within the overlap distance are included,
+     * so that tiles are stitched together by the edges joining vertices close to their common boundary: each of these edges is computed by
+     * a single tile. Visibility edges longer than the overlap across tile boundaries are left out, which makes the roadmap sparser than
+     * the one given by visibility() and RoadMap#build(). \n
+     *
+     * The result of a tile is moved into the roadmap as soon as it is ready, so that each worker holds a single tile at a time.
+     * As for roadmaps loaded from the cache, the result cannot be updated with RoadMap#update().
+     *
+     * @param[out] roadmap              Out: empty roadmap where the result is stored
+     * @param[in]  obstacles            Obstacles of the arena, used to select the vertices
+     * @param[in]  borders              Borders of the arena, used to select the vertices and split the arena
+     * @param[in]  offset               Inflation value of the obstacles for the vertices
+     * @param[in]  threshold            Minimum distance between consecutive vertices
+     * @param[in]  infObstacles         Inflated obstacles, for visibility and collision checking
+     * @param[in]  infBorders           Inflated borders, for visibility and collision checking
+     * @param[in]  orientationsPerNode  Number of poses to be created on each positional node
+     * @param[in]  kmax                 Maximum curvature of Dubins paths
+     * @param[in]  tiles                Number of tiles along each side of the arena
+     * @param[in]  overlap              Distance from its boundary within which the vertices of the neighbouring tiles are included in a tile
+     * @param[in]  threads              Optional: number of worker threads. If 0, one per hardware thread
+     * @return                      Number of Dubins paths that are created in the process
+     *
+     * @see makeVisibilityNodes()
+     * @see visibility()
+     * @see RoadMap#build()
+     */
+    unsigned long buildTiled(RoadMap &roadmap, const std::vector<Polygon> &obstacles, const Polygon &borders, float offset, float threshold,
+                             const std::vector<Polygon> &infObstacles, const Polygon &infBorders,
+                             unsigned int orientationsPerNode, float kmax, unsigned int tiles, float overlap, unsigned int threads = 0);
+}
@@ -21,6 +21,7 @@ namespace student
     *   -# A set of vertices are selected for the visibility graph, accounting for a distance from the inflated obstacles that allows for a higher chance of feasible Dubins curves existing. See rm::makeVisibilityNodes()
     *   -# A visibility graph is created as the base graph for the RoadMap. See rm::visibility()
     *   -# The RoadMap is built, pre-computing all feasible Dubins paths connecting nodes according to the base graph. See rm::RoadMap::build() and dubins
+    *   -# [Optional] Built roadmaps are cached in the config folder and loaded instead of the previous three steps when the arena is unchanged. See rm::loadRoadMap()
     *   -# The initial poses of the robots are added to the graph. See rm::RoadMap::addStartPose()
     *   -# The goal pose of each gate is computed and added to the graph. See rm::getGatePose() and rm::RoadMap::addGoalPose()
     *   -# Navigation maps to the goal poses are pre-computed. See nav::NavMap()
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file parallel.hpp
+ * @brief File dedicated to the parallelFor() function.
+ *
+ */
+
+namespace utils
+{
+    /**
+     * @brief Run a job for each index in [0, count) on a pool of threads, then rethrow the first exception of the jobs, if any.
+     *
+     * @param[in] count     Number of jobs
+     * @param[in] threads   Number of threads, the calling one included
+     * @param[in] job       Callable taking the index of the job
+     */
+    template <class Job>
+    void parallelFor(size_t count, unsigned int threads, Job job)
+    {
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto worker = [&]() {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                try
+                {
+                    job(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned int t = 1; t < threads; t++)
+            pool.push_back(std::thread(worker));
+        worker();
+        for (auto &thread : pool)
+            thread.join();
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,205 @@
+#include "nav/gatemap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nav
+{
+    const size_t GateMap::LANE_SIZE;
+    const size_t GateMap::SINGLE_PASS_GATES;
+
+    GateMap::GateMap(std::shared_ptr<const rm::Overlay> overlay) : _overlay(overlay), _lanes(0), _expanded(0) {}
+
+    void GateMap::compute(const std::vector<pose_id> &gates)
+    {
+        if (gates.empty())
+            throw std::logic_error("GATEMAP - NO GATES");
+        const size_t n_poses = _overlay->getPoseCount();
+        _gates = gates;
+        _expanded = 0;
+
+        if (gates.size() < SINGLE_PASS_GATES)
+        {
+            // A scalar search per gate, the maps of a previous computation are reused
+            _lanes = 0;
+            _values.clear();
+            _next.clear();
+            if (_maps.size() > gates.size())
+                _maps.erase(_maps.begin() + gates.size(), _maps.end());
+            while (_maps.size() < gates.size())
+                _maps.push_back(NavMap(_overlay));
+            for (size_t i = 0; i < gates.size(); i++)
+            {
+                _maps[i].computeReverse(gates[i]);
+                _expanded += _maps[i].getExpandedCount();
+            }
+        }
+        else
+        {
+            _maps.clear();
+            computeLanes();
+        }
+
+        // Nearest gate of every pose
+        _nearest_dist.assign(n_poses, INFINITY);
+        _nearest_gate.assign(n_poses, 0);
+        for (pose_id pose = 0; pose < n_poses; pose++)
+        {
+            for (size_t gate = 0; gate < gates.size(); gate++)
+            {
+                if (getDist(pose, gate) < _nearest_dist[pose])
+                {
+                    _nearest_dist[pose] = getDist(pose, gate);
+                    _nearest_gate[pose] = gate;
+                }
+            }
+        }
+    }
+
+    void GateMap::computeLanes()
+    {
+        const rm::Overlay &o = *_overlay;
+        const rm::FrozenRoadMap &g = o.getBase();
+        const size_t n_poses = o.getPoseCount();
+        const std::vector<pose_id> &gates = _gates;
+        _lanes = (gates.size() + LANE_SIZE - 1) / LANE_SIZE;
+
+        Lane empty;
+        std::fill(empty.dist, empty.dist + LANE_SIZE, INFINITY);
+        _values.assign(n_poses * _lanes, empty);
+        _next.assign(n_poses * _lanes * LANE_SIZE, rm::FrozenRoadMap::NONE);
+        _key.assign(n_poses, INFINITY);
+        _queue.reset(n_poses);
+
+        for (size_t i = 0; i < gates.size(); i++)
+        {
+            _values[gates[i] * _lanes + i / LANE_SIZE].dist[i % LANE_SIZE] = 0.0f;
+            _key[gates[i]] = 0.0f;
+            _queue.push(gates[i], 0.0f);
+        }
+
+        // A pose is taken again from the queue when one of its lanes improved, by the smallest improved value
+        while (!_queue.empty())
+        {
+            pose_id current = _queue.pop();
+            _key[current] = INFINITY;
+            _expanded++;
+
+            if (current < g.getPoseCount())
+            {
+                for (uint32_t i = g.getInBegin(current); i < g.getInEnd(current); i++)
+                {
+                    edge_id e = g.getInEdge(i);
+                    if (g.isUsable(e))
+                        relax(g.getFrom(e), current, e, g.getLength(e));
+                }
+            }
+            for (edge_id e : o.getInEdges(current))
+                relax(o.getFrom(e), current, e, o.getLength(e));
+        }
+    }
+
+    void GateMap::relax(pose_id from, pose_id to, edge_id e, float length)
+    {
+        float improved = INFINITY;
+        for (size_t lane = 0; lane < _lanes; lane++)
+        {
+            Lane &out = _values[from * _lanes + lane];
+            const Lane &in = _values[to * _lanes + lane];
+            // Branch-free with masks, so that all the gates of the lane are compared and updated by the same vector instructions
+            float gain[LANE_SIZE], lowest[LANE_SIZE];
+            for (size_t i = 0; i < LANE_SIZE; i++)
+                lowest[i] = gain[i] = in.dist[i] + length < out.dist[i] ? in.dist[i] + length : INFINITY;
+            // Pairwise minimum, without a chain of dependent comparisons
+            for (size_t width = LANE_SIZE / 2; width > 0; width /= 2)
+            {
+                for (size_t i = 0; i < width; i++)
+                    lowest[i] = std::min(lowest[i], lowest[i + width]);
+            }
+            // Most connections improve nothing, and the lane is left untouched
+            const float lane_improved = lowest[0];
+            if (lane_improved == INFINITY)
+                continue;
+            edge_id *next = &_next[(from * _lanes + lane) * LANE_SIZE];
+            for (size_t i = 0; i < LANE_SIZE; i++)
+            {
+                const uint32_t mask = -uint32_t(gain[i] < INFINITY);
+                next[i] = (e & mask) | (next[i] & ~mask);
+                out.dist[i] = std::min(gain[i], out.dist[i]);
+            }
+            improved = std::min(improved, lane_improved);
+        }
+        if (improved < _key[from])
+        {
+            _key[from] = improved;
+            _queue.push(from, improved);
+        }
+    }
+
+    float GateMap::getValue(pose_id pose, size_t gate) const
+    {
+        if (gate >= _gates.size())
+            throw std::logic_error("GATEMAP - INVALID GATE");
+        return getDist(pose, gate);
+    }
+
+    float GateMap::getNearestValue(pose_id pose) const
+    {
+        if (_gates.empty())
+            throw std::logic_error("GATEMAP - COMPUTATION REQUIRED BEFORE PLANNING");
+        return _nearest_dist[pose];
+    }
+
+    size_t GateMap::getNearestGate(pose_id pose) const
+    {
+        if (_gates.empty())
+            throw std::logic_error("GATEMAP - COMPUTATION REQUIRED BEFORE PLANNING");
+        return _nearest_gate[pose];
+    }
+
+    edgeList GateMap::planEdgesFrom(pose_id source, size_t gate) const
+    {
+        if (gate >= _gates.size())
+            throw std::logic_error("GATEMAP - INVALID GATE");
+        if (!_maps.empty())
+            return _maps[gate].planEdgesFrom(source);
+        edgeList path;
+        if (getValue(source, gate) == 0.0f)
+            return path;
+        if (getNext(source, gate) == rm::FrozenRoadMap::NONE)
+            throw std::logic_error("GATEMAP - NO EXISTING PATH CONNECTING SOURCE AND GATE");
+        for (edge_id e = getNext(source, gate); e != rm::FrozenRoadMap::NONE; e = getNext(_overlay->getTo(e), gate))
+            path.push_back(e);
+        return path;
+    }
+
+    edgeList GateMap::planEdgesFromNearest(pose_id source) const
+    {
+        return planEdgesFrom(source, getNearestGate(source));
+    }
+
+    bool GateMap::validate(const edgeList &path) const
+    {
+        const rm::FrozenRoadMap &g = _overlay->getBase();
+        const rm::RoadMap *roadmap = g.getRoadMap();
+        if (roadmap == nullptr)
+            return true;
+        bool valid = true;
+        for (const auto &edge : path)
+        {
+            // Connections of the overlay are checked when created
+            if (edge < g.getEdgeCount() && !roadmap->validate(*g.getConnection(edge)))
+                valid = false;
+        }
+        return valid;
+    }
+
+    bool GateMap::repair(const edgeList &path)
+    {
+        if (validate(path))
+            return true;
+        compute(std::vector<pose_id>(_gates));
+        return false;
+    }
+}
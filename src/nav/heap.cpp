@@ -0,0 +1,79 @@
+#include "nav/heap.hpp"
+
+namespace nav
+{
+    const uint32_t PoseHeap::NONE;
+
+    void PoseHeap::reset(size_t poses)
+    {
+        for (const auto &entry : _heap)
+            _position[entry.pose] = NONE;
+        _heap.clear();
+        _heap.reserve(poses);
+        if (_position.size() < poses)
+            _position.resize(poses, NONE);
+    }
+
+    void PoseHeap::push(pose_id pose, float key)
+    {
+        Entry entry = {key, pose};
+        if (_position[pose] == NONE)
+        {
+            _heap.push_back(entry);
+            siftUp(_heap.size() - 1, entry);
+        }
+        else
+            siftUp(_position[pose], entry);
+    }
+
+    PoseHeap::pose_id PoseHeap::pop()
+    {
+        pose_id top = _heap[0].pose;
+        _position[top] = NONE;
+        Entry last = _heap.back();
+        _heap.pop_back();
+        if (!_heap.empty())
+            siftDown(0, last);
+        return top;
+    }
+
+    void PoseHeap::siftUp(uint32_t index, Entry entry)
+    {
+        // Move parents down until the place of the entry is found, then store it once
+        while (index > 0)
+        {
+            uint32_t parent = (index - 1) / 4;
+            if (!less(entry, _heap[parent]))
+                break;
+            _heap[index] = _heap[parent];
+            _position[_heap[index].pose] = index;
+            index = parent;
+        }
+        _heap[index] = entry;
+        _position[entry.pose] = index;
+    }
+
+    void PoseHeap::siftDown(uint32_t index, Entry entry)
+    {
+        const uint32_t size = _heap.size();
+        while (true)
+        {
+            uint32_t first = 4 * index + 1;
+            if (first >= size)
+                break;
+            uint32_t best = first;
+            for (uint32_t child = first + 1; child < first + 4 && child < size; child++)
+            {
+                if (less(_heap[child], _heap[best]))
+                    best = child;
+            }
+            if (!less(_heap[best], entry))
+                break;
+            _heap[index] = _heap[best];
+            _position[_heap[index].pose] = index;
+            index = best;
+        }
+        _heap[index] = entry;
+        _position[entry.pose] = index;
+    }
+}
@@ -0,0 +1,128 @@
+#include "nav/hierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+namespace nav
+{
+    Hierarchy::Hierarchy(std::shared_ptr<const rm::FrozenRoadMap> graph, float regionSize)
+        : _graph(graph), _region_size(regionSize), _x0(0.0f), _y0(0.0f), _columns(1), _rows(1)
+    {
+        if (regionSize <= 0.0f)
+            throw std::logic_error("HIERARCHY - INVALID REGION SIZE");
+        const rm::FrozenRoadMap &g = *_graph;
+
+        // Grid of regions over the nodes
+        if (g.getNodeCount() > 0)
+        {
+            float x1 = -INFINITY, y1 = -INFINITY;
+            _x0 = INFINITY;
+            _y0 = INFINITY;
+            for (rm::RoadMap::node_id node = 0; node < g.getNodeCount(); node++)
+            {
+                _x0 = std::min(_x0, g.getX(node));
+                _y0 = std::min(_y0, g.getY(node));
+                x1 = std::max(x1, g.getX(node));
+                y1 = std::max(y1, g.getY(node));
+            }
+            _columns = static_cast<size_t>((x1 - _x0) / _region_size) + 1;
+            _rows = static_cast<size_t>((y1 - _y0) / _region_size) + 1;
+        }
+        _node_region.resize(g.getNodeCount());
+        for (rm::RoadMap::node_id node = 0; node < g.getNodeCount(); node++)
+            _node_region[node] = getRegion(g.getX(node), g.getY(node));
+
+        // Abstract edges, weighted by the shortest connection between the regions
+        _adjacent.resize(getRegionCount());
+        for (rm::FrozenRoadMap::pose_id pose = 0; pose < g.getPoseCount(); pose++)
+        {
+            size_t from = _node_region[g.getNode(pose)];
+            for (rm::FrozenRoadMap::edge_id e = g.getOutBegin(pose); e < g.getOutEnd(pose); e++)
+            {
+                size_t to = _node_region[g.getNode(g.getTo(e))];
+                if (to == from)
+                    continue;
+                auto it = std::find_if(_adjacent[from].begin(), _adjacent[from].end(),
+                                       [to](const std::pair<size_t, float> &edge) { return edge.first == to; });
+                if (it == _adjacent[from].end())
+                    _adjacent[from].push_back(std::make_pair(to, g.getLength(e)));
+                else
+                    it->second = std::min(it->second, g.getLength(e));
+            }
+        }
+    }
+
+    const rm::FrozenRoadMap &Hierarchy::getGraph() const
+    {
+        return *_graph;
+    }
+
+    size_t Hierarchy::getAbstractEdgeCount() const
+    {
+        size_t count = 0;
+        for (const auto &edges : _adjacent)
+            count += edges.size();
+        return count;
+    }
+
+    size_t Hierarchy::getRegion(float x, float y) const
+    {
+        float column = std::floor((x - _x0) / _region_size), row = std::floor((y - _y0) / _region_size);
+        size_t c = std::min<size_t>(_columns - 1, std::max(0.0f, column));
+        size_t r = std::min<size_t>(_rows - 1, std::max(0.0f, row));
+        return r * _columns + c;
+    }
+
+    std::vector<bool> Hierarchy::getCorridor(size_t source, const std::vector<size_t> &targets) const
+    {
+        // Shortest paths on the abstract graph
+        std::vector<float> dist(getRegionCount(), INFINITY);
+        std::vector<size_t> parent(getRegionCount(), getRegionCount());
+        typedef std::pair<float, size_t> dist_region;
+        std::set<dist_region> queue;
+        dist[source] = 0.0f;
+        queue.insert(dist_region(0.0f, source));
+        while (!queue.empty())
+        {
+            size_t current = queue.begin()->second;
+            queue.erase(queue.begin());
+            for (const auto &edge : _adjacent[current])
+            {
+                float d = dist[current] + edge.second;
+                if (d >= dist[edge.first])
+                    continue;
+                if (dist[edge.first] != INFINITY)
+                    queue.erase(dist_region(dist[edge.first], edge.first));
+                dist[edge.first] = d;
+                parent[edge.first] = current;
+                queue.insert(dist_region(d, edge.first));
+            }
+        }
+
+        // Regions along the paths to the targets
+        std::vector<bool> path(getRegionCount(), false);
+        path[source] = true;
+        for (size_t target : targets)
+        {
+            for (size_t region = target; region < getRegionCount() && !path[region] && dist[target] != INFINITY; region = parent[region])
+                path[region] = true;
+        }
+
+        // Widen the corridor by the neighbouring regions, since abstract costs do not account for the way across a region
+        std::vector<bool> corridor(getRegionCount(), false);
+        for (size_t region = 0; region < getRegionCount(); region++)
+        {
+            if (!path[region])
+                continue;
+            size_t r = region / _columns, c = region % _columns;
+            for (size_t nr = (r > 0 ? r - 1 : 0); nr <= std::min(r + 1, _rows - 1); nr++)
+            {
+                for (size_t nc = (c > 0 ? c - 1 : 0); nc <= std::min(c + 1, _columns - 1); nc++)
+                    corridor[nr * _columns + nc] = true;
+            }
+        }
+        return corridor;
+    }
+}
@@ -0,0 +1,168 @@
+#include "nav/landmarks.hpp"
+#include "nav/navmap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nav
+{
+    Landmarks::Landmarks(std::shared_ptr<const rm::FrozenRoadMap> graph, size_t count) : _graph(graph)
+    {
+        const size_t n_poses = _graph->getPoseCount();
+        if (n_poses == 0)
+            throw std::logic_error("LANDMARKS - EMPTY ROADMAP");
+        if (count == 0)
+            throw std::logic_error("LANDMARKS - NO LANDMARKS");
+
+        // Poses far from every landmark in both directions, so that dead ends of the roadmap, which reach no other pose, are not chosen
+        NavMap nm(_graph);
+        std::vector<float> to_pose(n_poses), from_pose(n_poses), closest(n_poses, INFINITY);
+        auto measure = [&](pose_id pose) {
+            nm.computeReverse(pose);
+            for (pose_id other = 0; other < n_poses; other++)
+                to_pose[other] = -nm.getValue(other);
+            nm.compute(pose);
+            for (pose_id other = 0; other < n_poses; other++)
+                from_pose[other] = nm.getValue(other);
+        };
+        auto getFarthest = [&]() {
+            pose_id farthest = rm::FrozenRoadMap::NONE;
+            float farthest_dist = 0.0f;
+            for (pose_id pose = 0; pose < n_poses; pose++)
+            {
+                closest[pose] = std::min(closest[pose], to_pose[pose] + from_pose[pose]);
+                if (!std::isinf(closest[pose]) && closest[pose] > farthest_dist)
+                {
+                    farthest = pose;
+                    farthest_dist = closest[pose];
+                }
+            }
+            return farthest;
+        };
+
+        // The search starts from the pose with the most connections both ways, which lies in the main part of the roadmap
+        auto getDegree = [&](pose_id pose) {
+            return std::min(_graph->getOutEnd(pose) - _graph->getOutBegin(pose), _graph->getInEnd(pose) - _graph->getInBegin(pose));
+        };
+        pose_id start = 0;
+        for (pose_id pose = 0; pose < n_poses; pose++)
+        {
+            if (getDegree(pose) > getDegree(start))
+                start = pose;
+        }
+        measure(start);
+        pose_id next = getFarthest();
+        std::fill(closest.begin(), closest.end(), INFINITY);
+
+        std::vector<std::vector<float>> to, from;
+        while (_landmarks.size() < count && next != rm::FrozenRoadMap::NONE)
+        {
+            _landmarks.push_back(next);
+            measure(next);
+            to.push_back(to_pose);
+            from.push_back(from_pose);
+            next = getFarthest();
+        }
+
+        // Distances of a pose to every landmark are stored together, since the heuristic reads all of them at once
+        const size_t n_landmarks = _landmarks.size();
+        _to.resize(n_poses * n_landmarks);
+        _from.resize(n_poses * n_landmarks);
+        for (pose_id pose = 0; pose < n_poses; pose++)
+        {
+            for (size_t i = 0; i < n_landmarks; i++)
+            {
+                _to[pose * n_landmarks + i] = to[i][pose];
+                _from[pose * n_landmarks + i] = from[i][pose];
+            }
+        }
+    }
+
+    const rm::FrozenRoadMap &Landmarks::getGraph() const
+    {
+        return *_graph;
+    }
+
+    size_t Landmarks::getMemorySize() const
+    {
+        return (_to.size() + _from.size()) * sizeof(float);
+    }
+
+    void Landmarks::getRow(pose_id pose, Row &row, const rm::Overlay *overlay) const
+    {
+        const size_t n_landmarks = _landmarks.size();
+        if (pose < _graph->getPoseCount())
+        {
+            row.to_lower.assign(_to.begin() + pose * n_landmarks, _to.begin() + (pose + 1) * n_landmarks);
+            row.from_lower.assign(_from.begin() + pose * n_landmarks, _from.begin() + (pose + 1) * n_landmarks);
+            row.to_upper = row.to_lower;
+            row.from_upper = row.from_lower;
+            return;
+        }
+        if (overlay == nullptr || &overlay->getBase() != _graph.get())
+            throw std::logic_error("LANDMARKS - POSE DOES NOT BELONG TO THE ROADMAP");
+
+        // Paths of overlay poses go through their neighbours: the ones in the roadmap give exact lengths, the others only their connection
+        row.to_lower.assign(n_landmarks, INFINITY);
+        row.to_upper.assign(n_landmarks, INFINITY);
+        row.from_lower.assign(n_landmarks, INFINITY);
+        row.from_upper.assign(n_landmarks, INFINITY);
+        for (auto e : overlay->getOutEdges(pose))
+        {
+            const pose_id next = overlay->getTo(e);
+            if (next == pose)
+                continue;
+            for (size_t i = 0; i < n_landmarks; i++)
+            {
+                const float length = overlay->getLength(e) + (overlay->isOverlay(next) ? 0.0f : _to[next * n_landmarks + i]);
+                row.to_lower[i] = std::min(row.to_lower[i], length);
+                if (!overlay->isOverlay(next))
+                    row.to_upper[i] = std::min(row.to_upper[i], length);
+            }
+        }
+        for (auto e : overlay->getInEdges(pose))
+        {
+            const pose_id previous = overlay->getFrom(e);
+            if (previous == pose)
+                continue;
+            for (size_t i = 0; i < n_landmarks; i++)
+            {
+                const float length = overlay->getLength(e) + (overlay->isOverlay(previous) ? 0.0f : _from[previous * n_landmarks + i]);
+                row.from_lower[i] = std::min(row.from_lower[i], length);
+                if (!overlay->isOverlay(previous))
+                    row.from_upper[i] = std::min(row.from_upper[i], length);
+            }
+        }
+    }
+
+    float Landmarks::getLowerBound(const Row &from, const Row &to) const
+    {
+        // Terms with an unknown or unreachable distance give no bound
+        float bound = 0.0f;
+        for (size_t i = 0; i < _landmarks.size(); i++)
+        {
+            if (!std::isinf(from.to_lower[i]) && !std::isinf(to.to_upper[i]))
+                bound = std::max(bound, from.to_lower[i] - to.to_upper[i]);
+            if (!std::isinf(to.from_lower[i]) && !std::isinf(from.from_upper[i]))
+                bound = std::max(bound, to.from_lower[i] - from.from_upper[i]);
+        }
+        return bound;
+    }
+
+    float Landmarks::getLowerBound(pose_id from, const Row &to) const
+    {
+        const size_t n_landmarks = _landmarks.size();
+        const float *from_to = &_to[from * n_landmarks];
+        const float *from_from = &_from[from * n_landmarks];
+        float bound = 0.0f;
+        for (size_t i = 0; i < n_landmarks; i++)
+        {
+            if (!std::isinf(from_to[i]) && !std::isinf(to.to_upper[i]))
+                bound = std::max(bound, from_to[i] - to.to_upper[i]);
+            if (!std::isinf(to.from_lower[i]) && !std::isinf(from_from[i]))
+                bound = std::max(bound, to.from_lower[i] - from_from[i]);
+        }
+        return bound;
+    }
+}
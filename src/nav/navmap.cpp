@@ -1,5 +1,6 @@
 #include "nav/navmap.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <set>
 #include <utility>
@@ -8,118 +9,531 @@
 
 namespace nav
 {
-    NavMap::NavMap(const rm::RoadMap &roadmap) : _rm(roadmap)
+    NavMap::NavMap(const rm::RoadMap &roadmap) : NavMap(roadmap.freeze()) {}
+
+    NavMap::NavMap(std::shared_ptr<const rm::FrozenRoadMap> graph) : _graph(graph), _origin(rm::FrozenRoadMap::NONE), _generation(0), _expanded(0), _radius(0.0f)
     {
         _need_computing = true;
         _reverse = false;
     }
 
+    NavMap::NavMap(std::shared_ptr<const rm::Overlay> overlay)
+        : _graph(overlay, &overlay->getBase()), _overlay(overlay), _origin(rm::FrozenRoadMap::NONE), _generation(0), _expanded(0), _radius(0.0f)
+    {
+        _need_computing = true;
+        _reverse = false;
+    }
+
+    const rm::FrozenRoadMap &NavMap::getGraph() const
+    {
+        return *_graph;
+    }
+
+    NavMap::pose_id NavMap::getPoseID(const rm::RoadMap::Node::Orientation &pose) const
+    {
+        if (_graph->getRoadMap() != &pose.getNode().getRoadMap())
+            throw std::logic_error("NAVMAP - POSE DOES NOT BELONG TO THE ROADMAP");
+        return _graph->getPoseID(pose);
+    }
+
+    navList NavMap::toNavList(const edgeList &edges) const
+    {
+        if (_graph->getRoadMap() == nullptr)
+            throw std::logic_error("NAVMAP - NAVIGATION LISTS REQUIRE A ROADMAP");
+        navList path;
+        for (const auto &edge : edges)
+        {
+            if (edge >= _graph->getEdgeCount())
+                throw std::logic_error("NAVMAP - NAVIGATION LISTS REQUIRE A ROADMAP");
+            path.push_back(_graph->getConnection(edge));
+        }
+        return path;
+    }
+
     void NavMap::compute(const rm::RoadMap::Node::Orientation &source)
+    {
+        compute(getPoseID(source));
+    }
+
+    void NavMap::compute(pose_id source)
+    {
+        search(source, nullptr, INFINITY, nullptr);
+    }
+
+    void NavMap::compute(pose_id source, float budget, const std::vector<rm::RoadMap::node_id> &targets)
+    {
+        search(source, nullptr, budget, &targets);
+    }
+
+    void NavMap::compute(pose_id source, const Hierarchy &hierarchy, const std::vector<rm::RoadMap::node_id> &targets)
+    {
+        if (&hierarchy.getGraph() != _graph.get())
+            throw std::logic_error("NAVMAP - HIERARCHY DOES NOT BELONG TO THE ROADMAP");
+
+        // Nodes of the overlay are placed in the region holding them
+        auto getRegion = [&](rm::RoadMap::node_id node) {
+            if (node < _graph->getNodeCount())
+                return hierarchy.getRegion(node);
+            pose_id pose = getFirstPose(node);
+            return hierarchy.getRegion(_overlay->getX(pose), _overlay->getY(pose));
+        };
+        std::vector<size_t> target_regions;
+        for (auto node : targets)
+            target_regions.push_back(getRegion(node));
+        std::vector<bool> corridor = hierarchy.getCorridor(getRegion(getNode(source)), target_regions);
+        std::vector<bool> allowed(_graph->getNodeCount());
+        for (rm::RoadMap::node_id node = 0; node < allowed.size(); node++)
+            allowed[node] = corridor[hierarchy.getRegion(node)];
+        search(source, &allowed, INFINITY, nullptr);
+        _radius = 0.0f;
+
+        for (auto node : targets)
+        {
+            if (std::isinf(getNodeValue(node)))
+            {
+                search(source, nullptr, INFINITY, nullptr);
+                break;
+            }
+        }
+    }
+
+    void NavMap::search(pose_id source, const std::vector<bool> *allowed, float budget, const std::vector<rm::RoadMap::node_id> *targets)
     {
         _reverse = false;
+        _origin = source;
         reset();
 
-        typedef std::pair<float, const rm::RoadMap::Node::Orientation &> dist_pose;
+        const rm::FrozenRoadMap &g = *_graph;
+        _queue.reset(getPoseCount());
 
-        auto cmp = [](dist_pose a, dist_pose b)
-        { return a.first == b.first ? &a.second < &b.second : a < b; };
-        std::set<dist_pose, decltype(cmp)> set_dist_pose(cmp);
+        // Target nodes are stamped with the generation until one of their poses is settled
+        size_t remaining = 0;
+        if (targets != nullptr && !targets->empty())
+        {
+            if (_target.size() < getNodeCount())
+                _target.resize(getNodeCount(), 0);
+            for (auto node : *targets)
+            {
+                if (_target[node] != _generation)
+                {
+                    _target[node] = _generation;
+                    remaining++;
+                }
+            }
+        }
 
-        _dist[source.getNode()][source] = 0.0f;
-        set_dist_pose.insert(dist_pose(0.0f, source));
+        setLabel(source, 0.0f, rm::FrozenRoadMap::NONE);
+        _queue.push(source, 0.0f);
 
-        while (!set_dist_pose.empty())
-        {
-            dist_pose top = *set_dist_pose.begin();
-            set_dist_pose.erase(set_dist_pose.begin());
+        // Edge relaxation, within the allowed nodes of the base roadmap
+        auto relax = [&](pose_id adj_pose, float dist, edge_id e) {
+            if (allowed != nullptr && adj_pose < g.getPoseCount() && !(*allowed)[g.getNode(adj_pose)])
+                return;
+            if (getDist(adj_pose) > dist)
+            {
+                // Update distance and shortest connection
+                setLabel(adj_pose, dist, e);
+                // Add pose to the queue, or move it up in place
+                _queue.push(adj_pose, dist);
+            }
+        };
 
-            auto &current_source_pose = top.second;
+        while (!_queue.empty() && _queue.getTopKey() <= budget)
+        {
+            pose_id current = _queue.pop();
+            const float current_dist = _labels[current].dist;
+            _expanded++;
 
-            for (size_t i = 0; i < current_source_pose.getConnectionCount(); i++)
+            // The value of a node is the one of its first settled pose
+            if (remaining > 0 && _target[getNode(current)] == _generation)
             {
-                auto &connection = current_source_pose.getConnection(i);
-                auto &adj_pose = *connection.to;
-                float dist_from_adjpose = connection.path.L;
+                _target[getNode(current)] = 0;
+                if (--remaining == 0)
+                    break;
+            }
 
-                // Edge relaxation
-                if (_dist[adj_pose.getNode()][adj_pose] > dist_from_adjpose + _dist[current_source_pose.getNode()][current_source_pose])
+            if (current < g.getPoseCount())
+            {
+                for (edge_id e = g.getOutBegin(current); e < g.getOutEnd(current); e++)
                 {
-                    // Remove from set to avoid duplicates
-                    if (_dist[adj_pose.getNode()][adj_pose] != INFINITY)
-                        set_dist_pose.erase(set_dist_pose.find(dist_pose(_dist[adj_pose.getNode()][adj_pose], adj_pose)));
-                    // Update distance and shortest connection
-                    _dist[adj_pose.getNode()][adj_pose] = dist_from_adjpose + _dist[current_source_pose.getNode()][current_source_pose];
-                    _connection[adj_pose.getNode()][adj_pose] = &connection;
-                    // Add node to set
-                    set_dist_pose.insert(dist_pose(_dist[adj_pose.getNode()][adj_pose], adj_pose));
+                    if (g.isUsable(e))
+                        relax(g.getTo(e), current_dist + g.getLength(e), e);
                 }
             }
+            if (_overlay)
+            {
+                for (edge_id e : _overlay->getOutEdges(current))
+                    relax(_overlay->getTo(e), current_dist + _overlay->getLength(e), e);
+            }
+        }
+
+        // Poses left in the queue were reached but not settled, so their values may not be the shortest ones
+        _radius = _queue.empty() ? INFINITY : _queue.getTopKey();
+        if (!_queue.empty())
+        {
+            for (size_t i = 0; i < _queue.size(); i++)
+                _labels[_queue.getPose(i)].generation = 0;
+            _queue.reset(getPoseCount());
+        }
+        if (remaining > 0)
+        {
+            for (auto node : *targets)
+                _target[node] = 0;
         }
 
         _need_computing = false;
     }
 
-    void NavMap::computeReverse(const rm::RoadMap::Node::Orientation &goal)
+    edgeList NavMap::planAStar(pose_id source, pose_id goal, float kmax)
     {
-        _reverse = true;
+        // Length of the path to the goal without obstacles, which never overestimates the remaining length.
+        // The Dubins length is consistent as well, since connections are Dubins paths.
+        dubins::Pose2D end;
+        end.x = getX(goal);
+        end.y = getY(goal);
+        end.theta = getTheta(goal);
+        return searchAStar(source, goal, [&](pose_id pose) {
+            float line = std::hypot(end.x - getX(pose), end.y - getY(pose));
+            if (kmax <= 0.0f)
+                return line;
+            dubins::Pose2D start;
+            start.x = getX(pose);
+            start.y = getY(pose);
+            start.theta = getTheta(pose);
+            std::set<dubins::DubinsCurve> curves;
+            dubins::findPaths(curves, start, end, kmax);
+            return curves.empty() ? line : std::max(line, curves.begin()->L);
+        });
+    }
+
+    edgeList NavMap::planAStar(pose_id source, pose_id goal, const Landmarks &landmarks)
+    {
+        if (&landmarks.getGraph() != _graph.get())
+            throw std::logic_error("NAVMAP - LANDMARKS OF A DIFFERENT ROADMAP");
+
+        // Both bounds never overestimate the remaining length, and so neither does the largest one
+        Landmarks::Row end, start;
+        landmarks.getRow(goal, end, _overlay.get());
+        const float end_x = getX(goal), end_y = getY(goal);
+        return searchAStar(source, goal, [&](pose_id pose) {
+            float line = std::hypot(end_x - getX(pose), end_y - getY(pose));
+            if (pose < _graph->getPoseCount())
+                return std::max(line, landmarks.getLowerBound(pose, end));
+            landmarks.getRow(pose, start, _overlay.get());
+            return std::max(line, landmarks.getLowerBound(start, end));
+        });
+    }
+
+    edgeList NavMap::searchAStar(pose_id source, pose_id goal, const std::function<float(pose_id)> &heuristic)
+    {
+        _reverse = false;
+        _origin = source;
         reset();
 
-        typedef std::pair<float, const rm::RoadMap::Node::Orientation &> dist_pose;
+        const rm::FrozenRoadMap &g = *_graph;
+        _queue.reset(getPoseCount());
 
-        auto cmp = [](dist_pose a, dist_pose b)
-        { return a.first == b.first ? &a.second < &b.second : a < b; };
-        std::set<dist_pose, decltype(cmp)> set_dist_pose(cmp);
+        if (_estimate.size() < getPoseCount())
+            _estimate.resize(getPoseCount());
+        _estimate[source] = heuristic(source);
+        setLabel(source, 0.0f, rm::FrozenRoadMap::NONE);
+        _queue.push(source, _estimate[source]);
 
-        _dist[goal.getNode()][goal] = 0.0f;
-        set_dist_pose.insert(dist_pose(0.0f, goal));
+        // Edge relaxation, queueing poses by their estimated total length. The bound is evaluated once, when a pose is first reached.
+        auto relax = [&](pose_id adj_pose, float dist, edge_id e) {
+            float current = getDist(adj_pose);
+            if (current > dist)
+            {
+                if (std::isinf(current))
+                    _estimate[adj_pose] = heuristic(adj_pose);
+                setLabel(adj_pose, dist, e);
+                _queue.push(adj_pose, dist + _estimate[adj_pose]);
+            }
+        };
 
-        while (!set_dist_pose.empty())
+        // Stop as soon as the goal is settled
+        while (!_queue.empty())
         {
-            dist_pose top = *set_dist_pose.begin();
-            set_dist_pose.erase(set_dist_pose.begin());
+            pose_id current = _queue.pop();
+            const float current_dist = _labels[current].dist;
+            _expanded++;
+            if (current == goal)
+                break;
 
-            auto &current_source_pose = top.second;
+            if (current < g.getPoseCount())
+            {
+                for (edge_id e = g.getOutBegin(current); e < g.getOutEnd(current); e++)
+                {
+                    if (g.isUsable(e))
+                        relax(g.getTo(e), current_dist + g.getLength(e), e);
+                }
+            }
+            if (_overlay)
+            {
+                for (edge_id e : _overlay->getOutEdges(current))
+                    relax(_overlay->getTo(e), current_dist + _overlay->getLength(e), e);
+            }
+        }
 
-            for (size_t i = 0; i < current_source_pose.getFromConnectionCount(); i++)
+        // Values of the poses that were not settled are not the shortest ones, so the map cannot be used for other plans
+        edgeList path;
+        if (goal == source)
+            return path;
+        if (getConnection(goal) == rm::FrozenRoadMap::NONE)
+            throw std::logic_error("NAVMAP - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
+        for (edge_id e = getConnection(goal); e != rm::FrozenRoadMap::NONE; e = getConnection(getFrom(e)))
+            path.push_front(e);
+        return path;
+    }
+
+    navList NavMap::planBidirectional(const rm::RoadMap::Node::Orientation &source, const rm::RoadMap::Node::Orientation &goal)
+    {
+        return toNavList(planBidirectional(getPoseID(source), getPoseID(goal)));
+    }
+
+    edgeList NavMap::planBidirectional(pose_id source, pose_id goal)
+    {
+        _reverse = false;
+        _origin = source;
+        reset();
+
+        const rm::FrozenRoadMap &g = *_graph;
+        _queue.reset(getPoseCount());
+        _backward_queue.reset(getPoseCount());
+        if (_backward.size() < getPoseCount())
+        {
+            _backward.resize(getPoseCount(), Label{0.0f, 0});
+            _backward_connection.resize(getPoseCount());
+        }
+
+        // Distances to the goal are positive, and stamped with the generation of the forward labels
+        auto getBackwardDist = [&](pose_id pose) { return _backward[pose].generation == _generation ? _backward[pose].dist : INFINITY; };
+
+        // Best path through a pose reached by both sides
+        float best = INFINITY;
+        pose_id meeting = rm::FrozenRoadMap::NONE;
+        auto meet = [&](pose_id pose) {
+            float length = getDist(pose) + getBackwardDist(pose);
+            if (length < best)
+            {
+                best = length;
+                meeting = pose;
+            }
+        };
+
+        auto relaxForward = [&](pose_id adj_pose, float dist, edge_id e) {
+            if (getDist(adj_pose) > dist)
+            {
+                setLabel(adj_pose, dist, e);
+                _queue.push(adj_pose, dist);
+                meet(adj_pose);
+            }
+        };
+        auto relaxBackward = [&](pose_id adj_pose, float dist, edge_id e) {
+            if (getBackwardDist(adj_pose) > dist)
             {
-                auto &connection = current_source_pose.getFromConnection(i);
-                auto &adj_pose = *connection.from;
-                float dist_from_adjpose = connection.path.L;
+                _backward[adj_pose] = Label{dist, _generation};
+                _backward_connection[adj_pose] = e;
+                _backward_queue.push(adj_pose, dist);
+                meet(adj_pose);
+            }
+        };
+
+        setLabel(source, 0.0f, rm::FrozenRoadMap::NONE);
+        _queue.push(source, 0.0f);
+        relaxBackward(goal, 0.0f, rm::FrozenRoadMap::NONE);
 
-                // Edge relaxation
-                if (_dist[adj_pose.getNode()][adj_pose] < _dist[current_source_pose.getNode()][current_source_pose] - dist_from_adjpose)
+        // When a side is exhausted, the best path is already known
+        while (!_queue.empty() && !_backward_queue.empty() && _queue.getTopKey() + _backward_queue.getTopKey() < best)
+        {
+            _expanded++;
+            if (_queue.getTopKey() <= _backward_queue.getTopKey())
+            {
+                pose_id current = _queue.pop();
+                const float current_dist = _labels[current].dist;
+                if (current < g.getPoseCount())
+                {
+                    for (edge_id e = g.getOutBegin(current); e < g.getOutEnd(current); e++)
+                    {
+                        if (g.isUsable(e))
+                            relaxForward(g.getTo(e), current_dist + g.getLength(e), e);
+                    }
+                }
+                if (_overlay)
                 {
-                    // Remove from set to avoid duplicates
-                    if (_dist[adj_pose.getNode()][adj_pose] != -INFINITY)
-                        set_dist_pose.erase(set_dist_pose.find(dist_pose(-_dist[adj_pose.getNode()][adj_pose], adj_pose)));
-                    // Update distance and shortest connection
-                    _dist[adj_pose.getNode()][adj_pose] = _dist[current_source_pose.getNode()][current_source_pose] - dist_from_adjpose;
-                    _connection[adj_pose.getNode()][adj_pose] = &connection;
-                    // Add node to set
-                    set_dist_pose.insert(dist_pose(-_dist[adj_pose.getNode()][adj_pose], adj_pose));
+                    for (edge_id e : _overlay->getOutEdges(current))
+                        relaxForward(_overlay->getTo(e), current_dist + _overlay->getLength(e), e);
+                }
+            }
+            else
+            {
+                pose_id current = _backward_queue.pop();
+                const float current_dist = _backward[current].dist;
+                if (current < g.getPoseCount())
+                {
+                    for (uint32_t i = g.getInBegin(current); i < g.getInEnd(current); i++)
+                    {
+                        edge_id e = g.getInEdge(i);
+                        if (g.isUsable(e))
+                            relaxBackward(g.getFrom(e), current_dist + g.getLength(e), e);
+                    }
+                }
+                if (_overlay)
+                {
+                    for (edge_id e : _overlay->getInEdges(current))
+                        relaxBackward(_overlay->getFrom(e), current_dist + _overlay->getLength(e), e);
                 }
             }
         }
 
+        // Join the forward path to the meeting pose with the backward path from it
+        if (meeting == rm::FrozenRoadMap::NONE)
+            throw std::logic_error("NAVMAP - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
+        edgeList path;
+        for (edge_id e = getConnection(meeting); e != rm::FrozenRoadMap::NONE; e = getConnection(getFrom(e)))
+            path.push_front(e);
+        for (edge_id e = _backward_connection[meeting]; e != rm::FrozenRoadMap::NONE; e = _backward_connection[getTo(e)])
+            path.push_back(e);
+        return path;
+    }
+
+    void NavMap::computeReverse(const rm::RoadMap::Node::Orientation &goal)
+    {
+        computeReverse(getPoseID(goal));
+    }
+
+    void NavMap::computeReverse(pose_id goal)
+    {
+        _reverse = true;
+        _origin = goal;
+        reset();
+
+        const rm::FrozenRoadMap &g = *_graph;
+        _queue.reset(getPoseCount());
+
+        setLabel(goal, 0.0f, rm::FrozenRoadMap::NONE);
+        _queue.push(goal, 0.0f);
+
+        // Edge relaxation
+        auto relax = [&](pose_id adj_pose, float dist, edge_id e) {
+            if (getDist(adj_pose) < dist)
+            {
+                // Update distance and shortest connection
+                setLabel(adj_pose, dist, e);
+                // Add pose to the queue, or move it up in place
+                _queue.push(adj_pose, -dist);
+            }
+        };
+
+        while (!_queue.empty())
+        {
+            pose_id current = _queue.pop();
+            const float current_dist = _labels[current].dist;
+            _expanded++;
+
+            if (current < g.getPoseCount())
+            {
+                for (uint32_t i = g.getInBegin(current); i < g.getInEnd(current); i++)
+                {
+                    edge_id e = g.getInEdge(i);
+                    if (g.isUsable(e))
+                        relax(g.getFrom(e), current_dist - g.getLength(e), e);
+                }
+            }
+            if (_overlay)
+            {
+                for (edge_id e : _overlay->getInEdges(current))
+                    relax(_overlay->getFrom(e), current_dist - _overlay->getLength(e), e);
+            }
+        }
+
         _need_computing = false;
     }
 
     void NavMap::reset()
     {
-        size_t pose_count = _rm.getNode(0).getPosesCount();
-        _dist = std::vector<std::vector<float>>(
-            _rm.getNodeCount(),
-            std::vector<float>(
-                pose_count,
-                _reverse ? -INFINITY : INFINITY));
-        _connection = std::vector<std::vector<rm::RoadMap::DubinsConnection const *>>(
-            _rm.getNodeCount(),
-            std::vector<rm::RoadMap::DubinsConnection const *>(
-                pose_count,
-                nullptr));
+        _expanded = 0;
+        _radius = 0.0f;
+
+        // Labels of the previous searches are discarded by moving to a new generation
+        if (_labels.size() < getPoseCount())
+        {
+            _labels.resize(getPoseCount(), Label{0.0f, 0});
+            _connection.resize(getPoseCount());
+        }
+        if (++_generation == 0)
+        {
+            for (auto &label : _labels)
+                label.generation = 0;
+            for (auto &label : _backward)
+                label.generation = 0;
+            std::fill(_target.begin(), _target.end(), 0);
+            _generation = 1;
+        }
         _need_computing = true;
     }
 
+    bool NavMap::validate(const navList &path) const
+    {
+        const rm::RoadMap *roadmap = _graph->getRoadMap();
+        if (roadmap == nullptr)
+            return true;
+        bool valid = true;
+        for (const auto &connection : path)
+        {
+            // Check every connection, so that all invalid ones are excluded at once
+            if (!roadmap->validate(*connection))
+                valid = false;
+        }
+        return valid;
+    }
+
+    bool NavMap::validate(const edgeList &path) const
+    {
+        const rm::RoadMap *roadmap = _graph->getRoadMap();
+        if (roadmap == nullptr)
+            return true;
+        bool valid = true;
+        for (const auto &edge : path)
+        {
+            // Connections of the overlay are checked when created
+            if (edge < _graph->getEdgeCount() && !roadmap->validate(*_graph->getConnection(edge)))
+                valid = false;
+        }
+        return valid;
+    }
+
+    bool NavMap::repair(const navList &path)
+    {
+        if (validate(path))
+            return true;
+        if (_reverse)
+            computeReverse(_origin);
+        else
+            compute(_origin);
+        return false;
+    }
+
+    bool NavMap::repair(const edgeList &path)
+    {
+        if (validate(path))
+            return true;
+        if (_reverse)
+            computeReverse(_origin);
+        else
+            compute(_origin);
+        return false;
+    }
+
+    navList NavMap::planLazy(const rm::RoadMap::Node::Orientation &source, const rm::RoadMap::Node::Orientation &goal)
+    {
+        compute(source);
+        navList path = planTo(goal);
+        while (!repair(path))
+            path = planTo(goal);
+        return path;
+    }
+
     bool NavMap::isReverse() const
     {
         return _reverse;
@@ -129,18 +543,31 @@ namespace nav
     {
         if (_need_computing)
             return _reverse ? -INFINITY : INFINITY;
-        return _dist[pose.getNode()][pose];
+        return getDist(getPoseID(pose));
+    }
+
+    float NavMap::getValue(pose_id pose) const
+    {
+        if (_need_computing)
+            return _reverse ? -INFINITY : INFINITY;
+        return getDist(pose);
     }
 
     float NavMap::getValue(const rm::RoadMap::Node &node) const
+    {
+        return getNodeValue(node.getID());
+    }
+
+    float NavMap::getNodeValue(rm::RoadMap::node_id node) const
     {
         float best = _reverse ? -INFINITY : INFINITY;
         if (_need_computing)
             return best;
-        for (size_t i = 0; i < node.getPosesCount(); i++)
+        pose_id first = getFirstPose(node);
+        for (size_t i = 0; i < getPosesCount(node); i++)
         {
-            if (_reverse ? _dist[node][i] > best : _dist[node][i] < best)
-                best = _dist[node][i];
+            if (_reverse ? getDist(first + i) > best : getDist(first + i) < best)
+                best = getDist(first + i);
         }
         return best;
     }
@@ -160,54 +587,79 @@ namespace nav
         return planTo(path.back()->to->getNode());
     }
 
+    edgeList NavMap::intercept(const edgeList &path, float offset) const
+    {
+        if (_reverse)
+            throw std::logic_error("NAVMAP - INTERCEPT ONLY AVAILABLE FOR DIRECT MAPS");
+        float running_length = -offset;
+        for (const auto &edge : path)
+        {
+            running_length += getLength(edge);
+            if (getNodeValue(getNode(getTo(edge))) <= running_length)
+                return planEdgesToNode(getNode(getTo(edge)));
+        }
+        // If there was no chance of intercepting, go to last node
+        return planEdgesToNode(getNode(getTo(path.back())));
+    }
+
     navList NavMap::planTo(const rm::RoadMap::Node &goal) const
+    {
+        return toNavList(planEdgesToNode(goal.getID()));
+    }
+
+    edgeList NavMap::planEdgesToNode(rm::RoadMap::node_id goal) const
     {
         if (_need_computing)
             throw std::logic_error("NAVMAP - COMPUTATION REQUIRED BEFORE PLANNING");
+        pose_id first = getFirstPose(goal);
         size_t best_id = 0;
-        for (size_t p_id = 1; p_id < goal.getPosesCount(); p_id++)
+        for (size_t p_id = 1; p_id < getPosesCount(goal); p_id++)
         {
-            if (_dist[goal][p_id] < _dist[goal][best_id])
+            if (getDist(first + p_id) < getDist(first + best_id))
                 best_id = p_id;
         }
-        return planTo(goal.getPose(best_id));
+        return planEdgesTo(first + best_id);
     }
 
     navList NavMap::planTo(const rm::RoadMap::Node::Orientation &goal) const
+    {
+        return toNavList(planEdgesTo(getPoseID(goal)));
+    }
+
+    navList NavMap::planFrom(const rm::RoadMap::Node::Orientation &source) const
+    {
+        return toNavList(planEdgesFrom(getPoseID(source)));
+    }
+
+    edgeList NavMap::planEdgesTo(pose_id goal) const
     {
         if (_need_computing)
             throw std::logic_error("NAVMAP - COMPUTATION REQUIRED BEFORE PLANNING");
         if (_reverse)
             throw std::logic_error("NAVMAP - WRONG PLANNING DIRECTION");
-        navList path;
-        if (_dist[goal.getNode()][goal] == 0.0f)
+        edgeList path;
+        if (getDist(goal) == 0.0f)
             return path;
-        path.push_front(_connection[goal.getNode()][goal]);
-        if (path.front() == nullptr)
+        if (getConnection(goal) == rm::FrozenRoadMap::NONE)
             throw std::logic_error("NAVMAP - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
-        while (_connection[path.front()->from->getNode()][*path.front()->from] != nullptr)
-        {
-            path.push_front(_connection[path.front()->from->getNode()][*path.front()->from]);
-        }
+        for (edge_id e = getConnection(goal); e != rm::FrozenRoadMap::NONE; e = getConnection(getFrom(e)))
+            path.push_front(e);
         return path;
     }
 
-    navList NavMap::planFrom(const rm::RoadMap::Node::Orientation &source) const
+    edgeList NavMap::planEdgesFrom(pose_id source) const
     {
         if (_need_computing)
             throw std::logic_error("NAVMAP - COMPUTATION REQUIRED BEFORE PLANNING");
         if (!_reverse)
             throw std::logic_error("NAVMAP - WRONG PLANNING DIRECTION");
-        navList path;
-        if (_dist[source.getNode()][source] == 0.0f)
+        edgeList path;
+        if (getDist(source) == 0.0f)
             return path;
-        path.push_back(_connection[source.getNode()][source]);
-        if (path.front() == nullptr)
+        if (getConnection(source) == rm::FrozenRoadMap::NONE)
             throw std::logic_error("NAVMAP - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
-        while (_connection[path.back()->to->getNode()][*path.back()->to] != nullptr)
-        {
-            path.push_back(_connection[path.back()->to->getNode()][*path.back()->to]);
-        }
+        for (edge_id e = getConnection(source); e != rm::FrozenRoadMap::NONE; e = getConnection(getTo(e)))
+            path.push_back(e);
         return path;
     }
-}
\ No newline at end of file
+}
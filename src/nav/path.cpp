@@ -1,7 +1,10 @@
 #include "nav/path.hpp"
 
+#include "rm/geometry.hpp"
 #include "utils.hpp"
 
+#include <cmath>
+#include <set>
 #include <vector>
 
 namespace nav
@@ -33,6 +36,207 @@ namespace nav
         }
     }
 
+    void discretizePath(const rm::FrozenRoadMap &graph, const edgeList &edge_list, float step, std::vector<Pose> &discr_path)
+    {
+        float offset = 0.0f;
+        for (const auto &edge : edge_list)
+            dubins::discretizeCurve(graph.getPath(edge), step, offset, discr_path);
+    }
+
+    void discretizePath(const rm::Overlay &overlay, const edgeList &edge_list, float step, std::vector<Pose> &discr_path)
+    {
+        float offset = 0.0f;
+        for (size_t i = 0; i < edge_list.size(); i++)
+        {
+            rm::Overlay::edge_id edge = edge_list[i];
+            if (overlay.isWait(edge))
+            {
+                if (i == edge_list.size() - 1)
+                    break;
+                rm::Overlay::pose_id wait_pose = overlay.getTo(edge);
+                Pose pose(discr_path.back().s + step - offset,
+                          overlay.getX(wait_pose), overlay.getY(wait_pose), overlay.getTheta(wait_pose), 0.0f);
+                offset = 0.0f;
+                float end_goal = pose.s + overlay.getLength(edge);
+                while (pose.s + step <= end_goal)
+                {
+                    discr_path.push_back(pose);
+                    pose.s += step;
+                }
+                continue;
+            }
+
+            dubins::discretizeCurve(overlay.getPath(edge), step, offset, discr_path);
+        }
+    }
+
+    namespace
+    {
+        /** Window of candidate headings at the first iteration, on each side of the current heading: half the spacing of 4 poses per node */
+        const float REFINE_WINDOW = M_PI / 4;
+
+        /**
+         * @brief Find the shortest collision-free Dubins path between two poses, if it is shorter than a bound.
+         *
+         * @param[in]  start     Starting pose
+         * @param[in]  end       Destination pose
+         * @param[in]  kmax      Maximum curvature of Dubins paths
+         * @param[in]  obstacles Obstacles for collision checking
+         * @param[in]  borders   Borders for collision checking
+         * @param[in]  bound     Length the path should be shorter than
+         * @param[out] out       Out: shortest collision-free path, if found
+         * @return           true if a path was found, false otherwise
+         */
+        bool shortestFree(const dubins::Pose2D &start, const dubins::Pose2D &end, float kmax,
+                          const std::vector<Polygon> &obstacles, const Polygon &borders, float bound, dubins::DubinsCurve &out)
+        {
+            std::set<dubins::DubinsCurve> curves;
+            dubins::findPaths(curves, start, end, kmax);
+            for (const auto &curve : curves)
+            {
+                // Curves are sorted by length
+                if (curve.L >= bound)
+                    return false;
+                if (!rm::collisionCheck(curve, obstacles, borders))
+                {
+                    out = curve;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Refine a sequence of connections without wait connections.
+         *
+         * @return  true if a shorter sequence was found and added to the overlay, false if the given sequence should be kept
+         */
+        bool refineRun(rm::Overlay &overlay, const edgeList &edge_list, size_t begin, size_t end, float kmax,
+                       const std::vector<Polygon> &obstacles, const Polygon &borders,
+                       unsigned int samples, unsigned int iterations, edgeList &out)
+        {
+            // Via points, with the current headings
+            std::vector<dubins::Pose2D> via;
+            float length = 0.0f;
+            for (size_t i = begin; i <= end; i++)
+            {
+                rm::Overlay::pose_id pose = i < end ? overlay.getFrom(edge_list[i]) : overlay.getTo(edge_list[end - 1]);
+                via.push_back(dubins::Pose2D{overlay.getX(pose), overlay.getY(pose), overlay.getTheta(pose)});
+                if (i < end)
+                    length += overlay.getLength(edge_list[i]);
+            }
+            const size_t n = via.size();
+            const size_t n_candidates = 2 * samples + 1;
+
+            // Candidate headings of each via point: the ends are fixed, intermediate ones get a window around the current heading
+            std::vector<std::vector<dubins::Pose2D>> candidates(n);
+            std::vector<std::vector<float>> cost(n);
+            std::vector<std::vector<size_t>> prev(n);
+            std::vector<std::vector<dubins::DubinsCurve>> paths(n);
+            float best = length;
+            float window = REFINE_WINDOW;
+            for (unsigned int it = 0; it < iterations; it++)
+            {
+                for (size_t k = 0; k < n; k++)
+                {
+                    candidates[k].clear();
+                    if (k == 0 || k == n - 1)
+                        candidates[k].push_back(via[k]);
+                    else
+                    {
+                        for (size_t j = 0; j < n_candidates; j++)
+                        {
+                            dubins::Pose2D pose = via[k];
+                            pose.theta = dubins::mod2pi(pose.theta + window * ((float)j - samples) / samples);
+                            candidates[k].push_back(pose);
+                        }
+                    }
+                    cost[k].assign(candidates[k].size(), INFINITY);
+                    prev[k].assign(candidates[k].size(), 0);
+                    paths[k].assign(candidates[k].size(), dubins::DubinsCurve());
+                }
+
+                // Shortest chain of paths through the candidates
+                cost[0][0] = 0.0f;
+                for (size_t k = 1; k < n; k++)
+                {
+                    for (size_t j = 0; j < candidates[k].size(); j++)
+                    {
+                        for (size_t i = 0; i < candidates[k - 1].size(); i++)
+                        {
+                            if (std::isinf(cost[k - 1][i]))
+                                continue;
+                            dubins::DubinsCurve curve;
+                            if (shortestFree(candidates[k - 1][i], candidates[k][j], kmax, obstacles, borders,
+                                             cost[k][j] - cost[k - 1][i], curve))
+                            {
+                                cost[k][j] = cost[k - 1][i] + curve.L;
+                                prev[k][j] = i;
+                                paths[k][j] = curve;
+                            }
+                        }
+                    }
+                }
+                if (std::isinf(cost[n - 1][0]))
+                    return false;
+
+                // Center the next window on the chosen headings
+                size_t j = 0;
+                for (size_t k = n - 1; k > 0; k--)
+                {
+                    j = prev[k][j];
+                    via[k - 1] = candidates[k - 1][j];
+                }
+                best = cost[n - 1][0];
+                window *= 0.5f;
+            }
+            if (best >= length)
+                return false;
+
+            // Rebuild the chosen chain of paths
+            std::vector<dubins::DubinsCurve> chain(n - 1);
+            size_t j = 0;
+            for (size_t k = n - 1; k > 0; k--)
+            {
+                chain[k - 1] = paths[k][j];
+                j = prev[k][j];
+            }
+            rm::Overlay::pose_id pose = overlay.getFrom(edge_list[begin]);
+            for (size_t k = 0; k < chain.size(); k++)
+            {
+                rm::Overlay::edge_id edge = overlay.addPath(pose, chain[k], k == chain.size() - 1 ? overlay.getTo(edge_list[end - 1]) : rm::FrozenRoadMap::NONE);
+                out.push_back(edge);
+                pose = overlay.getTo(edge);
+            }
+            return true;
+        }
+    }
+
+    edgeList refinePath(rm::Overlay &overlay, const edgeList &edge_list, float kmax,
+                        const std::vector<Polygon> &obstacles, const Polygon &borders,
+                        unsigned int samples, unsigned int iterations)
+    {
+        edgeList out;
+        size_t begin = 0;
+        while (begin < edge_list.size())
+        {
+            if (overlay.isWait(edge_list[begin]))
+            {
+                out.push_back(edge_list[begin++]);
+                continue;
+            }
+            // Wait connections split the path, so that the robot waits with the same pose
+            size_t end = begin;
+            while (end < edge_list.size() && !overlay.isWait(edge_list[end]))
+                end++;
+            if (end - begin < 2 || samples == 0 ||
+                !refineRun(overlay, edge_list, begin, end, kmax, obstacles, borders, samples, iterations, out))
+                out.insert(out.end(), edge_list.begin() + begin, edge_list.begin() + end);
+            begin = end;
+        }
+        return out;
+    }
+
     void truncatePaths(std::vector<Pose> &discr_path1, std::vector<Pose> &discr_path2, float robot_size)
     {
         size_t max_count = discr_path1.size() > discr_path2.size() ? discr_path1.size() : discr_path2.size();
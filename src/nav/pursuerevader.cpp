@@ -1,39 +1,47 @@
 #include "nav/pursuerevader.hpp"
+#include "nav/table.hpp"
 
+#include <cmath>
 #include <vector>
 #include <random>
 
 namespace nav
 {
 
-    rm::RoadMap::DubinsConnection *create_wait_connection(rm::RoadMap::Node::Orientation *pose, float s)
-    {
-        dubins::DubinsCurve wait_path;
-        wait_path.L = s;
-        return new rm::RoadMap::DubinsConnection(pose, pose, wait_path);
-    }
-
-    bool movePursuer(const float &evader_s, float &pursuer_s, const int &goal, const std::vector<nav::NavMap> &nm_e, nav::NavMap &nm_p,
-                     const rm::RoadMap::Node::Orientation &source_e, const rm::RoadMap::Node::Orientation &source_p,
-                     const nav::navList &nav_list_e, nav::navList &nav_list_p)
+    bool movePursuer(const float &evader_s, float &pursuer_s, const int &goal, nav::GateMap &gates, nav::Replanner &replanner,
+                     rm::Overlay &overlay, rm::Overlay::pose_id source_e, rm::Overlay::pose_id source_p,
+                     const nav::edgeList &nav_list_e, nav::edgeList &nav_list_p, const nav::DistanceTable *table)
     {
         // Predict evader's path
-        nav::navList tmp_path;
-        auto e_best_path = nm_e[goal].planFrom(nav_list_e.empty() ? source_e : *nav_list_e.back()->from);
+        nav::edgeList tmp_path;
+        const auto pose_e = nav_list_e.empty() ? source_e : overlay.getFrom(nav_list_e.back());
+        const auto pose_p = nav_list_p.empty() ? source_p : overlay.getTo(nav_list_p.back());
+        auto e_best_path = gates.planEdgesFrom(pose_e, goal);
+        // Lazy roadmaps: replan until the predicted path is feasible
+        while (!gates.repair(e_best_path))
+            e_best_path = gates.planEdgesFrom(pose_e, goal);
 
         if (e_best_path.size() == 1)
         {
             // Evader is already heading to a gate, so the pursuer will try to go there too
-            tmp_path = nm_e[goal].planFrom(nav_list_p.empty() ? source_p : *nav_list_p.back()->to);
+            tmp_path = gates.planEdgesFrom(pose_p, goal);
+            while (!gates.repair(tmp_path))
+                tmp_path = gates.planEdgesFrom(pose_p, goal);
         }
         else
         {
-            // Recompute navmap
-            nm_p.compute(nav_list_p.empty() ? source_p : *nav_list_p.back()->to);
             try
             {
-                // Intercept evader in its path to current goal
-                tmp_path = nm_p.intercept(e_best_path, e_best_path.front()->path.L - evader_s + pursuer_s);
+                // Intercept evader in its path to current goal, from the table or reusing the previous search when it is enough to decide
+                float offset = overlay.getLength(e_best_path.front()) - evader_s + pursuer_s;
+                if (table != nullptr)
+                    tmp_path = table->intercept(overlay, pose_p, e_best_path, offset);
+                else
+                {
+                    tmp_path = replanner.intercept(pose_p, e_best_path, offset);
+                    while (!replanner.repair(tmp_path))
+                        tmp_path = replanner.intercept(pose_p, e_best_path, offset);
+                }
             }
             catch (const std::logic_error &e)
             {
@@ -49,47 +57,50 @@ namespace nav
             {
                 // Planned movement was completed
                 // Check if meeting evader next
-                if (nav_list_e.back()->to->getNode().getID() == nav_list_p.back()->to->getNode().getID())
+                if (overlay.getNode(overlay.getTo(nav_list_e.back())) == overlay.getNode(overlay.getTo(nav_list_p.back())))
                     return true;
                 // Otherwise create a waiting task until the evader takes a new move
                 pursuer_s = evader_s;
-                nav_list_p.push_back(create_wait_connection(nav_list_p.back()->to, evader_s - pursuer_s));
+                nav_list_p.push_back(overlay.addWait(overlay.getTo(nav_list_p.back()), evader_s - pursuer_s));
                 return false;
             }
             // Add path segment to output
             nav_list_p.push_back(tmp_path.front());
             tmp_path.pop_front();
             // Update pursuer_s
-            pursuer_s += nav_list_p.back()->path.L;
+            pursuer_s += overlay.getLength(nav_list_p.back());
         }
         return false;
     }
 
-    bool moveEvader(float &evader_s, const float &pursuer_s, int &goal, const std::vector<nav::NavMap> &nm_e,
-                    const rm::RoadMap::Node::Orientation &source_e, nav::navList &nav_list_e, const nav::navList &nav_list_p)
+    bool moveEvader(float &evader_s, const float &pursuer_s, int &goal, nav::GateMap &gates,
+                    const rm::Overlay &overlay, rm::Overlay::pose_id source_e, nav::edgeList &nav_list_e, const nav::edgeList &nav_list_p)
     {
 
         // Prepare random number generation
         std::random_device rd;
         std::mt19937 mt(rd());
-        std::uniform_int_distribution<int> dist(0, nm_e.size() - 1);
+        std::uniform_int_distribution<int> dist(0, gates.getGateCount() - 1);
         while (evader_s <= pursuer_s)
         {
             // Pick random exit
             goal = dist(mt);
             // Plan path to that exit
-            auto tmp_path = nm_e[goal].planFrom(nav_list_e.empty() ? source_e : *nav_list_e.back()->to);
+            const auto pose_e = nav_list_e.empty() ? source_e : overlay.getTo(nav_list_e.back());
+            auto tmp_path = gates.planEdgesFrom(pose_e, goal);
+            while (!gates.repair(tmp_path))
+                tmp_path = gates.planEdgesFrom(pose_e, goal);
             // Add path segment to output
             nav_list_e.push_back(tmp_path.front());
             // Update evader_s
-            evader_s += nav_list_e.back()->path.L;
+            evader_s += overlay.getLength(nav_list_e.back());
             // Check if caught
             if (!nav_list_p.empty())
             {
-                auto e_to = nav_list_e.back()->to->getNode().getID();
-                auto e_from = nav_list_e.back()->from->getNode().getID();
-                auto p_to = nav_list_p.back()->to->getNode().getID();
-                auto p_from = nav_list_p.back()->from->getNode().getID();
+                auto e_to = overlay.getNode(overlay.getTo(nav_list_e.back()));
+                auto e_from = overlay.getNode(overlay.getFrom(nav_list_e.back()));
+                auto p_to = overlay.getNode(overlay.getTo(nav_list_p.back()));
+                auto p_from = overlay.getNode(overlay.getFrom(nav_list_p.back()));
                 if (e_to == p_to || (e_to == p_from && e_from == p_to))
                     return true;
             }
@@ -103,9 +114,9 @@ namespace nav
         return false;
     }
 
-    void runGame(const std::vector<nav::NavMap> &nm_e, nav::NavMap &nm_p,
-                 const rm::RoadMap::Node::Orientation &source_e, const rm::RoadMap::Node::Orientation &source_p,
-                 nav::navList &nav_list_e, nav::navList &nav_list_p)
+    void runGame(nav::GateMap &gates, nav::Replanner &replanner, rm::Overlay &overlay,
+                 rm::Overlay::pose_id source_e, rm::Overlay::pose_id source_p,
+                 nav::edgeList &nav_list_e, nav::edgeList &nav_list_p, const nav::DistanceTable *table)
     {
         float evader_s = 0.0f, pursuer_s = 0.0f;
         int goal;
@@ -114,13 +125,13 @@ namespace nav
         while (true)
         {
             // Move evader
-            if (moveEvader(evader_s, pursuer_s, goal, nm_e, source_e, nav_list_e, nav_list_p))
+            if (moveEvader(evader_s, pursuer_s, goal, gates, overlay, source_e, nav_list_e, nav_list_p))
                 return;
 
             /* Goal prediction would go here */
 
             // Move pursuer
-            if (movePursuer(evader_s, pursuer_s, goal, nm_e, nm_p, source_e, source_p, nav_list_e, nav_list_p))
+            if (movePursuer(evader_s, pursuer_s, goal, gates, replanner, overlay, source_e, source_p, nav_list_e, nav_list_p, table))
                 return;
         }
     }
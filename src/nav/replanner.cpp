@@ -0,0 +1,150 @@
+#include "nav/replanner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nav
+{
+    Replanner::Replanner(NavMap &map, const rm::Overlay &overlay, const Hierarchy *hierarchy)
+        : _map(map), _overlay(overlay), _hierarchy(hierarchy), _root(rm::FrozenRoadMap::NONE), _pose_count(0), _steps(0), _searches(0), _expanded(0)
+    {
+    }
+
+    void Replanner::reset()
+    {
+        _root = rm::FrozenRoadMap::NONE;
+    }
+
+    bool Replanner::repair(const edgeList &path)
+    {
+        if (_map.validate(path))
+            return true;
+        reset();
+        return false;
+    }
+
+    void Replanner::search(pose_id source, const std::vector<rm::RoadMap::node_id> &targets)
+    {
+        if (_hierarchy != nullptr)
+            _map.compute(source, *_hierarchy, targets);
+        else
+            _map.compute(source, INFINITY, targets);
+        _searches++;
+        _expanded += _map.getExpandedCount();
+        // Values restricted to a corridor are not the shortest ones, so they cannot be reused
+        _root = _hierarchy != nullptr ? rm::FrozenRoadMap::NONE : source;
+        _pose_count = _overlay.getPoseCount();
+    }
+
+    bool Replanner::canReuse(pose_id source) const
+    {
+        if (_root == rm::FrozenRoadMap::NONE || source >= _pose_count || std::isinf(_map.getValue(source)))
+            return false;
+        // Connections found invalid since the search make the distance of the source longer, and the bounds wrong
+        for (auto edge : _map.planEdgesTo(source))
+        {
+            if (!_overlay.isOverlayEdge(edge) && !_overlay.getBase().isUsable(edge))
+                return false;
+        }
+        return true;
+    }
+
+    bool Replanner::isBelow(pose_id pose, pose_id source, float shift) const
+    {
+        if (pose == source)
+            return true;
+        if (_map.getValue(pose) < shift)
+            return false;
+        for (auto edge : _map.planEdgesTo(pose))
+        {
+            if (_overlay.getFrom(edge) == source)
+                return true;
+        }
+        return false;
+    }
+
+    void Replanner::evaluate(rm::RoadMap::node_id node, pose_id source, float &exact, pose_id &best, float &lower) const
+    {
+        const float shift = _map.getValue(source), radius = _map.getSettledRadius();
+        exact = lower = INFINITY;
+        best = rm::FrozenRoadMap::NONE;
+        pose_id first = _overlay.getFirstPose(node);
+        for (size_t i = 0; i < _overlay.getPosesCount(node); i++)
+        {
+            const pose_id pose = first + i;
+            if (pose >= _pose_count)
+            {
+                // Added after the search, so not reached by it
+                lower = std::min(lower, radius - shift);
+                continue;
+            }
+            const float value = _map.getValue(pose);
+            if (std::isinf(value))
+                lower = std::min(lower, radius - shift);
+            else if (isBelow(pose, source, shift))
+            {
+                if (value - shift < exact)
+                {
+                    exact = value - shift;
+                    best = pose;
+                }
+            }
+            else
+                lower = std::min(lower, value - shift);
+        }
+    }
+
+    edgeList Replanner::planSuffix(pose_id goal, pose_id source) const
+    {
+        edgeList path = _map.planEdgesTo(goal);
+        while (!path.empty() && _overlay.getFrom(path.front()) != source)
+            path.pop_front();
+        return path;
+    }
+
+    edgeList Replanner::intercept(pose_id source, const edgeList &path, float offset)
+    {
+        _steps++;
+        if (canReuse(source))
+        {
+            float running_length = -offset;
+            float exact, lower;
+            pose_id best;
+            size_t i = 0;
+            for (const auto &edge : path)
+            {
+                running_length += _overlay.getLength(edge);
+                evaluate(_overlay.getNode(_overlay.getTo(edge)), source, exact, best, lower);
+                // The distance of the node is known when a pose below the source is closer than the bound of the other ones
+                if (++i == path.size() || std::min(exact, lower) <= running_length)
+                {
+                    if (exact < lower)
+                        return planSuffix(best, source);
+                    break;
+                }
+            }
+        }
+
+        // Same search as a full computation, stopping when the nodes of the path are settled
+        std::vector<rm::RoadMap::node_id> targets;
+        for (auto edge : path)
+            targets.push_back(_overlay.getNode(_overlay.getTo(edge)));
+        search(source, targets);
+        return _map.intercept(path, offset);
+    }
+
+    edgeList Replanner::planEdgesToNode(pose_id source, rm::RoadMap::node_id goal)
+    {
+        _steps++;
+        if (canReuse(source))
+        {
+            float exact, lower;
+            pose_id best;
+            evaluate(goal, source, exact, best, lower);
+            if (exact < lower)
+                return planSuffix(best, source);
+        }
+        search(source, std::vector<rm::RoadMap::node_id>(1, goal));
+        return _map.planEdgesToNode(goal);
+    }
+}
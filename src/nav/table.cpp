@@ -0,0 +1,277 @@
+#include "nav/table.hpp"
+
+#include "nav/heap.hpp"
+#include "utils/parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+namespace nav
+{
+    namespace
+    {
+        const uint16_t NO_NEXT = UINT16_MAX;
+
+        /**
+         * @brief Round a non-negative distance to the nearest 16-bit float. Values below the smallest normal one are flushed to 0.
+         */
+        uint16_t toHalf(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            bits &= 0x7FFFFFFF;
+            if (bits >= 0x477FF000)
+                return 0x7C00;
+            if (bits < 0x38800000)
+                return 0;
+            return static_cast<uint16_t>((bits - (112u << 23) + 0x1000) >> 13);
+        }
+
+        float toFloat(uint16_t half)
+        {
+            if (half >= 0x7C00)
+                return INFINITY;
+            if (half == 0)
+                return 0.0f;
+            uint32_t bits = (static_cast<uint32_t>(half) + (112u << 10)) << 13;
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+    }
+
+    DistanceTable::DistanceTable(std::shared_ptr<const rm::FrozenRoadMap> graph, unsigned int threads) : _graph(graph), _n_poses(graph->getPoseCount())
+    {
+        const rm::FrozenRoadMap &g = *_graph;
+        if (g.getRoadMap() != nullptr && g.getRoadMap()->isLazy())
+            throw std::logic_error("TABLE - LAZY ROADMAPS NOT SUPPORTED");
+        for (pose_id pose = 0; pose < _n_poses; pose++)
+        {
+            if (g.getOutEnd(pose) - g.getOutBegin(pose) >= NO_NEXT)
+                throw std::logic_error("TABLE - TOO MANY CONNECTIONS");
+        }
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        // One row per source pose, filled by its own search
+        _dist.resize(_n_poses * _n_poses);
+        _next.resize(_n_poses * _n_poses);
+        utils::parallelFor(_n_poses, threads, [&](size_t source) {
+            std::vector<float> dist;
+            std::vector<uint16_t> first;
+            searchFrom(source, dist, first);
+            for (pose_id pose = 0; pose < _n_poses; pose++)
+            {
+                _dist[source * _n_poses + pose] = toHalf(dist[pose]);
+                _next[source * _n_poses + pose] = first[pose];
+            }
+        });
+    }
+
+    void DistanceTable::searchFrom(pose_id source, std::vector<float> &dist, std::vector<uint16_t> &first) const
+    {
+        const rm::FrozenRoadMap &g = *_graph;
+        dist.assign(_n_poses, INFINITY);
+        first.assign(_n_poses, NO_NEXT);
+        PoseHeap queue;
+        queue.reset(_n_poses);
+
+        dist[source] = 0.0f;
+        queue.push(source, 0.0f);
+        while (!queue.empty())
+        {
+            pose_id current = queue.pop();
+            for (edge_id e = g.getOutBegin(current); e < g.getOutEnd(current); e++)
+            {
+                pose_id adj_pose = g.getTo(e);
+                float adj_dist = dist[current] + g.getLength(e);
+                if (g.isUsable(e) && adj_dist < dist[adj_pose])
+                {
+                    // The first connection of the path is inherited from the pose it is reached from
+                    dist[adj_pose] = adj_dist;
+                    first[adj_pose] = current == source ? e - g.getOutBegin(source) : first[current];
+                    queue.push(adj_pose, adj_dist);
+                }
+            }
+        }
+    }
+
+    const rm::FrozenRoadMap &DistanceTable::getGraph() const
+    {
+        return *_graph;
+    }
+
+    size_t DistanceTable::getMemorySize() const
+    {
+        return (_dist.size() + _next.size()) * sizeof(uint16_t);
+    }
+
+    float DistanceTable::getDistance(pose_id from, pose_id to) const
+    {
+        return toFloat(_dist[from * _n_poses + to]);
+    }
+
+    edgeList DistanceTable::planEdges(pose_id from, pose_id to) const
+    {
+        const rm::FrozenRoadMap &g = *_graph;
+        edgeList path;
+        for (pose_id pose = from; pose != to; pose = g.getTo(path.back()))
+        {
+            uint16_t next = _next[pose * _n_poses + to];
+            if (next == NO_NEXT)
+                throw std::logic_error("TABLE - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
+            path.push_back(g.getOutBegin(pose) + next);
+        }
+        return path;
+    }
+
+    void DistanceTable::checkOverlay(const rm::Overlay &overlay) const
+    {
+        if (&overlay.getBase() != _graph.get())
+            throw std::logic_error("TABLE - OVERLAY OF A DIFFERENT ROADMAP");
+    }
+
+    void DistanceTable::searchOverlay(const rm::Overlay &overlay, pose_id pose, bool forward, LabelMap &labels) const
+    {
+        // Search over the poses of the overlay only, stopping at the poses of the roadmap it reaches
+        labels.clear();
+        labels[pose] = Label{0.0f, rm::FrozenRoadMap::NONE};
+        std::set<std::pair<float, pose_id>> queue;
+        queue.insert(std::make_pair(0.0f, pose));
+        while (!queue.empty())
+        {
+            pose_id current = queue.begin()->second;
+            float current_dist = queue.begin()->first;
+            queue.erase(queue.begin());
+            if (!overlay.isOverlay(current))
+                continue;
+            for (edge_id e : forward ? overlay.getOutEdges(current) : overlay.getInEdges(current))
+            {
+                pose_id adj_pose = forward ? overlay.getTo(e) : overlay.getFrom(e);
+                float adj_dist = current_dist + overlay.getLength(e);
+                auto it = labels.find(adj_pose);
+                if (it != labels.end() && it->second.dist <= adj_dist)
+                    continue;
+                if (it != labels.end())
+                    queue.erase(std::make_pair(it->second.dist, adj_pose));
+                labels[adj_pose] = Label{adj_dist, e};
+                queue.insert(std::make_pair(adj_dist, adj_pose));
+            }
+        }
+    }
+
+    float DistanceTable::getValue(const LabelMap &from, const LabelMap &to, pose_id goal, pose_id &entry, pose_id &exit) const
+    {
+        // Paths within the overlay, then paths entering and leaving the roadmap
+        float best = INFINITY;
+        entry = exit = rm::FrozenRoadMap::NONE;
+        auto direct = from.find(goal);
+        if (direct != from.end() && direct->first >= _n_poses)
+            best = direct->second.dist;
+        for (const auto &in : from)
+        {
+            if (in.first >= _n_poses)
+                continue;
+            for (const auto &out : to)
+            {
+                if (out.first >= _n_poses)
+                    continue;
+                float value = in.second.dist + getDistance(in.first, out.first) + out.second.dist;
+                if (value < best)
+                {
+                    best = value;
+                    entry = in.first;
+                    exit = out.first;
+                }
+            }
+        }
+        return best;
+    }
+
+    float DistanceTable::getNodeValue(const rm::Overlay &overlay, const LabelMap &from, rm::RoadMap::node_id node, LabelMap &to, pose_id &goal,
+                                      pose_id &entry, pose_id &exit) const
+    {
+        float best = INFINITY;
+        LabelMap labels;
+        pose_id first = overlay.getFirstPose(node);
+        for (size_t i = 0; i < overlay.getPosesCount(node); i++)
+        {
+            pose_id pose_entry, pose_exit;
+            searchOverlay(overlay, first + i, false, labels);
+            float value = getValue(from, labels, first + i, pose_entry, pose_exit);
+            if (i == 0 || value < best)
+            {
+                best = value;
+                goal = first + i;
+                entry = pose_entry;
+                exit = pose_exit;
+                to.swap(labels);
+            }
+        }
+        return best;
+    }
+
+    edgeList DistanceTable::unroll(const rm::Overlay &overlay, const LabelMap &from, const LabelMap &to, pose_id goal, pose_id entry, pose_id exit) const
+    {
+        edgeList path;
+        if (entry == rm::FrozenRoadMap::NONE)
+        {
+            for (edge_id e = from.at(goal).connection; e != rm::FrozenRoadMap::NONE; e = from.at(overlay.getFrom(e)).connection)
+                path.push_front(e);
+            return path;
+        }
+        for (edge_id e = from.at(entry).connection; e != rm::FrozenRoadMap::NONE; e = from.at(overlay.getFrom(e)).connection)
+            path.push_front(e);
+        for (auto e : planEdges(entry, exit))
+            path.push_back(e);
+        for (edge_id e = to.at(exit).connection; e != rm::FrozenRoadMap::NONE; e = to.at(overlay.getTo(e)).connection)
+            path.push_back(e);
+        return path;
+    }
+
+    edgeList DistanceTable::planEdgesTo(const rm::Overlay &overlay, pose_id source, pose_id goal) const
+    {
+        checkOverlay(overlay);
+        LabelMap from, to;
+        pose_id entry, exit;
+        searchOverlay(overlay, source, true, from);
+        searchOverlay(overlay, goal, false, to);
+        if (std::isinf(getValue(from, to, goal, entry, exit)))
+            throw std::logic_error("TABLE - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
+        return unroll(overlay, from, to, goal, entry, exit);
+    }
+
+    edgeList DistanceTable::planEdgesToNode(const rm::Overlay &overlay, pose_id source, rm::RoadMap::node_id goal) const
+    {
+        checkOverlay(overlay);
+        LabelMap from, to;
+        pose_id goal_pose, entry, exit;
+        searchOverlay(overlay, source, true, from);
+        if (std::isinf(getNodeValue(overlay, from, goal, to, goal_pose, entry, exit)))
+            throw std::logic_error("TABLE - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
+        return unroll(overlay, from, to, goal_pose, entry, exit);
+    }
+
+    edgeList DistanceTable::intercept(const rm::Overlay &overlay, pose_id source, const edgeList &path, float offset) const
+    {
+        checkOverlay(overlay);
+        LabelMap from, to;
+        pose_id goal, entry, exit;
+        searchOverlay(overlay, source, true, from);
+        float running_length = -offset;
+        for (const auto &edge : path)
+        {
+            running_length += overlay.getLength(edge);
+            if (getNodeValue(overlay, from, overlay.getNode(overlay.getTo(edge)), to, goal, entry, exit) <= running_length)
+                return unroll(overlay, from, to, goal, entry, exit);
+        }
+        // If there was no chance of intercepting, go to last node
+        if (std::isinf(getNodeValue(overlay, from, overlay.getNode(overlay.getTo(path.back())), to, goal, entry, exit)))
+            throw std::logic_error("TABLE - NO EXISTING PATH CONNECTING SOURCE AND GOAL");
+        return unroll(overlay, from, to, goal, entry, exit);
+    }
+}
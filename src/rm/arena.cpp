@@ -0,0 +1,50 @@
+#include "rm/arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace rm
+{
+    const size_t Arena::BLOCK_SIZE;
+
+    Arena::Arena(size_t size) : _head(nullptr), _left(0), _block_size(BLOCK_SIZE), _capacity(0), _used(0)
+    {
+        if (size > 0)
+            addBlock(size);
+    }
+
+    void Arena::addBlock(size_t size)
+    {
+        _blocks.push_back(std::unique_ptr<char[]>(new char[size]));
+        _head = _blocks.back().get();
+        _left = size;
+        _capacity += size;
+        // Blocks grow with the arena, so that large graphs need few of them
+        _block_size = std::max(_block_size, _capacity / 2);
+    }
+
+    void *Arena::allocate(size_t bytes, size_t align)
+    {
+        size_t padding = (align - reinterpret_cast<uintptr_t>(_head) % align) % align;
+        if (_head == nullptr || padding + bytes > _left)
+        {
+            addBlock(std::max(_block_size, bytes + align));
+            padding = (align - reinterpret_cast<uintptr_t>(_head) % align) % align;
+        }
+        void *out = _head + padding;
+        _head += padding + bytes;
+        _left -= padding + bytes;
+        _used += padding + bytes;
+        return out;
+    }
+
+    void Arena::reserve(size_t bytes)
+    {
+        if (bytes > _left)
+            addBlock(bytes);
+    }
+
+    size_t Arena::getUsed() const { return _used; }
+
+    size_t Arena::getCapacity() const { return _capacity; }
+}
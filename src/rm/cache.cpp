@@ -0,0 +1,354 @@
+#include "rm/cache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <utility>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace rm
+{
+    namespace
+    {
+        const char MAGIC[4] = {'R', 'M', 'A', 'P'};
+        const uint32_t VERSION = 1;
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint64_t key;
+            uint64_t nodes;
+            uint64_t links;
+            uint64_t poses;
+            uint64_t connections;
+            uint32_t curve_size;
+            uint32_t reserved;
+        };
+
+        struct NodeRecord
+        {
+            float x;
+            float y;
+            uint32_t poses;
+            uint32_t links;
+        };
+
+        struct ConnectionRecord
+        {
+            uint32_t from;
+            uint32_t to;
+            dubins::DubinsCurve path;
+        };
+
+        // FNV-1a
+        void hashBytes(uint64_t &hash, const void *data, size_t size)
+        {
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        void hashCoordinate(uint64_t &hash, float value, float resolution)
+        {
+            if (resolution <= 0.0f)
+            {
+                hashBytes(hash, &value, sizeof(value));
+                return;
+            }
+            int64_t cell = std::llround(value / resolution);
+            hashBytes(hash, &cell, sizeof(cell));
+        }
+
+        void hashPolygon(uint64_t &hash, const Polygon &polygon, float resolution)
+        {
+            uint64_t size = polygon.size();
+            hashBytes(hash, &size, sizeof(size));
+            for (const auto &p : polygon)
+            {
+                hashCoordinate(hash, p.x, resolution);
+                hashCoordinate(hash, p.y, resolution);
+            }
+        }
+
+        const char CACHE_PREFIX[] = "roadmap_";
+        const char CACHE_SUFFIX[] = ".bin";
+
+        // Counts are bounded by the size of the file before any product, so that a corrupted header cannot overflow the expected size
+        bool hasSize(const Header &h, size_t size)
+        {
+            if (h.nodes > size / sizeof(NodeRecord) || h.links > size / sizeof(uint32_t) ||
+                h.poses > size / sizeof(float) || h.connections > size / sizeof(ConnectionRecord))
+                return false;
+            return sizeof(Header) + h.nodes * sizeof(NodeRecord) + h.links * sizeof(uint32_t) +
+                       h.poses * sizeof(float) + h.connections * sizeof(ConnectionRecord) == size;
+        }
+    }
+
+    uint64_t hashArena(const Polygon &borders, const std::vector<Polygon> &obstacles,
+                       unsigned int orientationsPerNode, float kmax, const std::vector<float> &offsets, float resolution)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        hashBytes(hash, &VERSION, sizeof(VERSION));
+        hashBytes(hash, &resolution, sizeof(resolution));
+        hashPolygon(hash, borders, resolution);
+        uint64_t count = obstacles.size();
+        hashBytes(hash, &count, sizeof(count));
+        for (const auto &obst : obstacles)
+            hashPolygon(hash, obst, resolution);
+        hashBytes(hash, &orientationsPerNode, sizeof(orientationsPerNode));
+        hashBytes(hash, &kmax, sizeof(kmax));
+        for (const auto &offset : offsets)
+            hashBytes(hash, &offset, sizeof(offset));
+        return hash;
+    }
+
+    std::string getCacheFile(const std::string &folder, uint64_t key)
+    {
+        std::stringstream ss;
+        ss << folder << "/" << CACHE_PREFIX << std::hex << std::setw(16) << std::setfill('0') << key << CACHE_SUFFIX;
+        return ss.str();
+    }
+
+    bool saveRoadMap(const RoadMap &roadmap, const std::string &file, uint64_t key)
+    {
+        if (roadmap.isLazy())
+            return false;
+
+        // Global index of the first pose of each node
+        std::vector<uint32_t> first_pose(roadmap.getNodeCount());
+        Header h;
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.key = key;
+        h.nodes = roadmap.getNodeCount();
+        h.links = 0;
+        h.poses = 0;
+        h.connections = 0;
+        h.curve_size = sizeof(dubins::DubinsCurve);
+        h.reserved = 0;
+        for (size_t i = 0; i < roadmap.getNodeCount(); i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            first_pose[i] = h.poses;
+            h.links += node.getConnectedCount();
+            h.poses += node.getPosesCount();
+            for (size_t j = 0; j < node.getPosesCount(); j++)
+            {
+                const RoadMap::Node::Orientation &pose = node.getPose(j);
+                for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                    h.connections += roadmap.getState(pose.getConnection(c)) != RoadMap::INVALID;
+            }
+        }
+
+        // Write to a temporary file of this process first, so that readers and other writers never see a partial roadmap
+        std::vector<char> tmp_name(file.begin(), file.end());
+        const char tmp_suffix[] = ".XXXXXX";
+        tmp_name.insert(tmp_name.end(), tmp_suffix, tmp_suffix + sizeof(tmp_suffix));
+        int fd = mkstemp(tmp_name.data());
+        if (fd < 0)
+            return false;
+        fchmod(fd, 0644);
+        close(fd);
+        const std::string tmp_file(tmp_name.data());
+        std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        for (size_t i = 0; i < roadmap.getNodeCount(); i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            NodeRecord record = {node.getX(), node.getY(),
+                                 static_cast<uint32_t>(node.getPosesCount()),
+                                 static_cast<uint32_t>(node.getConnectedCount())};
+            out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+        for (size_t i = 0; i < roadmap.getNodeCount(); i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            for (size_t j = 0; j < node.getConnectedCount(); j++)
+            {
+                uint32_t to = node.getConnected(j).getID();
+                out.write(reinterpret_cast<const char *>(&to), sizeof(to));
+            }
+        }
+        for (size_t i = 0; i < roadmap.getNodeCount(); i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            for (size_t j = 0; j < node.getPosesCount(); j++)
+            {
+                float theta = node.getPose(j).getTheta();
+                out.write(reinterpret_cast<const char *>(&theta), sizeof(theta));
+            }
+        }
+        for (size_t i = 0; i < roadmap.getNodeCount(); i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            for (size_t j = 0; j < node.getPosesCount(); j++)
+            {
+                const RoadMap::Node::Orientation &pose = node.getPose(j);
+                for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                {
+                    const RoadMap::DubinsConnection &connection = pose.getConnection(c);
+                    if (roadmap.getState(connection) == RoadMap::INVALID)
+                        continue;
+                    ConnectionRecord record;
+                    record.from = first_pose[i] + j;
+                    record.to = first_pose[connection.to->getNode().getID()] + connection.to->getID();
+                    record.path = connection.path;
+                    out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+                }
+            }
+        }
+        out.close();
+        if (!out)
+        {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+        if (std::rename(tmp_file.c_str(), file.c_str()) != 0)
+        {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool loadRoadMap(RoadMap &roadmap, const std::string &file, uint64_t key)
+    {
+        if (roadmap.getNodeCount() != 0)
+            return false;
+
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+        {
+            close(fd);
+            return false;
+        }
+        size_t size = st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        const char *ptr = static_cast<const char *>(data);
+        const Header &h = *reinterpret_cast<const Header *>(ptr);
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION || h.key != key ||
+            h.curve_size != sizeof(dubins::DubinsCurve) || !hasSize(h, size))
+        {
+            munmap(data, size);
+            return false;
+        }
+        const NodeRecord *nodes = reinterpret_cast<const NodeRecord *>(ptr + sizeof(Header));
+        const uint32_t *links = reinterpret_cast<const uint32_t *>(nodes + h.nodes);
+        const float *thetas = reinterpret_cast<const float *>(links + h.links);
+        const ConnectionRecord *connections = reinterpret_cast<const ConnectionRecord *>(thetas + h.poses);
+
+        // Check every index before touching the roadmap
+        uint64_t n_links = 0, n_poses = 0;
+        for (size_t i = 0; i < h.nodes; i++)
+        {
+            n_links += nodes[i].links;
+            n_poses += nodes[i].poses;
+        }
+        bool ok = n_links == h.links && n_poses == h.poses;
+        for (size_t i = 0; i < h.links && ok; i++)
+            ok = links[i] < h.nodes;
+        for (size_t i = 0; i < h.connections && ok; i++)
+            ok = connections[i].from < h.poses && connections[i].to < h.poses;
+        if (!ok)
+        {
+            munmap(data, size);
+            return false;
+        }
+
+        // Nodes must all be created before any pose, so that poses keep a valid parent
+        for (size_t i = 0; i < h.nodes; i++)
+            roadmap.addNode(Point(nodes[i].x, nodes[i].y));
+
+        std::vector<RoadMap::Node::Orientation *> poses;
+        poses.reserve(h.poses);
+        for (size_t i = 0; i < h.nodes; i++)
+        {
+            RoadMap::Node &node = roadmap.getNode(i);
+            for (size_t j = 0; j < nodes[i].links; j++)
+                node.connectTo(*links++);
+            for (size_t j = 0; j < nodes[i].poses; j++)
+                node.addPose(*thetas++);
+        }
+        for (size_t i = 0; i < h.nodes; i++)
+        {
+            RoadMap::Node &node = roadmap.getNode(i);
+            for (size_t j = 0; j < node.getPosesCount(); j++)
+                poses.push_back(&node.getPose(j));
+        }
+        // Connection lists are allocated once, with their exact size
+        std::vector<uint32_t> n_out(h.poses, 0), n_in(h.poses, 0);
+        for (size_t i = 0; i < h.connections; i++)
+        {
+            n_out[connections[i].from]++;
+            n_in[connections[i].to]++;
+        }
+        for (size_t i = 0; i < h.poses; i++)
+            poses[i]->reserve(n_out[i], n_in[i]);
+        for (size_t i = 0; i < h.connections; i++)
+            poses[connections[i].from]->addConnection(*poses[connections[i].to], connections[i].path);
+
+        munmap(data, size);
+
+        // A hit makes the file the most recently used one
+        utimes(file.c_str(), nullptr);
+        return true;
+    }
+
+    size_t pruneCache(const std::string &folder, size_t count)
+    {
+        DIR *dir = opendir(folder.c_str());
+        if (dir == nullptr)
+            return 0;
+        const size_t prefix = sizeof(CACHE_PREFIX) - 1, suffix = sizeof(CACHE_SUFFIX) - 1;
+        std::vector<std::pair<time_t, std::string>> files;
+        while (dirent *entry = readdir(dir))
+        {
+            const std::string name(entry->d_name);
+            if (name.size() <= prefix + suffix || name.compare(0, prefix, CACHE_PREFIX) != 0 ||
+                name.compare(name.size() - suffix, suffix, CACHE_SUFFIX) != 0)
+                continue;
+            const std::string path = folder + "/" + name;
+            struct stat st;
+            if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+                files.push_back(std::make_pair(st.st_mtime, path));
+        }
+        closedir(dir);
+        if (files.size() <= count)
+            return 0;
+
+        // Most recently used first
+        std::sort(files.begin(), files.end(), [](const std::pair<time_t, std::string> &a, const std::pair<time_t, std::string> &b) { return a.first > b.first; });
+        size_t removed = 0;
+        for (size_t i = count; i < files.size(); i++)
+            removed += std::remove(files[i].second.c_str()) == 0;
+        return removed;
+    }
+}
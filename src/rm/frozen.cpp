@@ -0,0 +1,325 @@
+#include "rm/frozen.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rm
+{
+    const uint32_t FrozenRoadMap::NONE;
+
+    namespace
+    {
+        const char MAGIC[4] = {'R', 'M', 'F', 'Z'};
+        const uint32_t VERSION = 1;
+
+        enum Section
+        {
+            NODES,
+            POSES,
+            OUT_BEGIN,
+            IN_BEGIN,
+            EDGE_FROM,
+            EDGE_TO,
+            EDGE_LENGTH,
+            EDGE_PATH,
+            IN_EDGE,
+            SECTION_COUNT
+        };
+
+        // Every field of the image is addressed by its offset from the beginning of the image
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t curve_size;
+            uint32_t reserved;
+            uint64_t nodes;
+            uint64_t poses;
+            uint64_t edges;
+            uint64_t offset[SECTION_COUNT];
+            uint64_t size[SECTION_COUNT];
+        };
+
+        size_t align(size_t offset)
+        {
+            return (offset + 7) & ~static_cast<size_t>(7);
+        }
+    }
+
+    FrozenRoadMap::FrozenRoadMap(const RoadMap &roadmap) : _mapped(nullptr), _size(0), _source(&roadmap), _lazy(roadmap.isLazy())
+    {
+        // Count elements
+        uint64_t n_nodes = roadmap.getNodeCount(), n_poses = 0, n_edges = 0;
+        for (size_t i = 0; i < n_nodes; i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            n_poses += node.getPosesCount();
+            for (size_t j = 0; j < node.getPosesCount(); j++)
+            {
+                const RoadMap::Node::Orientation &orientation = node.getPose(j);
+                for (size_t c = 0; c < orientation.getConnectionCount(); c++)
+                    n_edges += roadmap.getState(orientation.getConnection(c)) != RoadMap::INVALID;
+            }
+        }
+        if (n_poses >= NONE || n_edges >= NONE)
+            throw std::logic_error("FROZEN ROADMAP - ROADMAP TOO LARGE");
+
+        // Layout
+        Header h;
+        std::memset(&h, 0, sizeof(h));
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.curve_size = sizeof(dubins::DubinsCurve);
+        h.nodes = n_nodes;
+        h.poses = n_poses;
+        h.edges = n_edges;
+        h.size[NODES] = n_nodes * sizeof(NodeRecord);
+        h.size[POSES] = n_poses * sizeof(PoseRecord);
+        h.size[OUT_BEGIN] = (n_poses + 1) * sizeof(edge_id);
+        h.size[IN_BEGIN] = (n_poses + 1) * sizeof(uint32_t);
+        h.size[EDGE_FROM] = n_edges * sizeof(pose_id);
+        h.size[EDGE_TO] = n_edges * sizeof(pose_id);
+        h.size[EDGE_LENGTH] = n_edges * sizeof(float);
+        h.size[EDGE_PATH] = n_edges * sizeof(dubins::DubinsCurve);
+        h.size[IN_EDGE] = n_edges * sizeof(edge_id);
+        size_t offset = align(sizeof(Header));
+        for (size_t s = 0; s < SECTION_COUNT; s++)
+        {
+            h.offset[s] = offset;
+            offset = align(offset + h.size[s]);
+        }
+        _buffer.assign(offset, 0);
+        std::memcpy(_buffer.data(), &h, sizeof(h));
+
+        char *data = _buffer.data();
+        NodeRecord *nodes = reinterpret_cast<NodeRecord *>(data + h.offset[NODES]);
+        PoseRecord *poses = reinterpret_cast<PoseRecord *>(data + h.offset[POSES]);
+        edge_id *out_begin = reinterpret_cast<edge_id *>(data + h.offset[OUT_BEGIN]);
+        uint32_t *in_begin = reinterpret_cast<uint32_t *>(data + h.offset[IN_BEGIN]);
+        pose_id *edge_from = reinterpret_cast<pose_id *>(data + h.offset[EDGE_FROM]);
+        pose_id *edge_to = reinterpret_cast<pose_id *>(data + h.offset[EDGE_TO]);
+        float *edge_length = reinterpret_cast<float *>(data + h.offset[EDGE_LENGTH]);
+        dubins::DubinsCurve *edge_path = reinterpret_cast<dubins::DubinsCurve *>(data + h.offset[EDGE_PATH]);
+        edge_id *in_edge = reinterpret_cast<edge_id *>(data + h.offset[IN_EDGE]);
+
+        // Nodes and poses
+        pose_id pose = 0;
+        for (size_t i = 0; i < n_nodes; i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            nodes[i].x = node.getX();
+            nodes[i].y = node.getY();
+            nodes[i].first_pose = pose;
+            nodes[i].pose_count = node.getPosesCount();
+            for (size_t j = 0; j < node.getPosesCount(); j++, pose++)
+            {
+                poses[pose].theta = node.getPose(j).getTheta();
+                poses[pose].node = i;
+            }
+        }
+
+        // Outgoing connections, grouped by starting pose
+        _links.reserve(n_edges);
+        _link_ids.reserve(n_edges);
+        edge_id edge = 0;
+        pose = 0;
+        for (size_t i = 0; i < n_nodes; i++)
+        {
+            const RoadMap::Node &node = roadmap.getNode(i);
+            for (size_t j = 0; j < node.getPosesCount(); j++, pose++)
+            {
+                const RoadMap::Node::Orientation &orientation = node.getPose(j);
+                out_begin[pose] = edge;
+                for (size_t c = 0; c < orientation.getConnectionCount(); c++)
+                {
+                    // Connections known to collide are left out of the image
+                    const RoadMap::DubinsConnection &connection = orientation.getConnection(c);
+                    if (roadmap.getState(connection) == RoadMap::INVALID)
+                        continue;
+                    edge_from[edge] = pose;
+                    edge_to[edge] = nodes[connection.to->getNode().getID()].first_pose + connection.to->getID();
+                    edge_length[edge] = connection.path.L;
+                    edge_path[edge] = connection.path;
+                    _links.push_back(&connection);
+                    // State lookups read the IDs in edge order, without visiting the connections of the RoadMap
+                    _link_ids.push_back(connection.id);
+                    edge++;
+                }
+            }
+        }
+        out_begin[n_poses] = edge;
+
+        // Incoming connections, grouped by destination pose (counting sort)
+        for (edge_id e = 0; e < n_edges; e++)
+            in_begin[edge_to[e] + 1]++;
+        for (pose_id p = 0; p < n_poses; p++)
+            in_begin[p + 1] += in_begin[p];
+        std::vector<uint32_t> fill(in_begin, in_begin + n_poses);
+        for (edge_id e = 0; e < n_edges; e++)
+            in_edge[fill[edge_to[e]]++] = e;
+
+        attach(_buffer.data(), _buffer.size());
+    }
+
+    FrozenRoadMap::FrozenRoadMap(const std::string &file) : _mapped(nullptr), _size(0), _source(nullptr), _lazy(false)
+    {
+        int fd = open(file.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::logic_error("FROZEN ROADMAP - UNABLE TO OPEN IMAGE");
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+        {
+            close(fd);
+            throw std::logic_error("FROZEN ROADMAP - INVALID IMAGE");
+        }
+        _size = st.st_size;
+        _mapped = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (_mapped == MAP_FAILED)
+        {
+            _mapped = nullptr;
+            throw std::logic_error("FROZEN ROADMAP - UNABLE TO MAP IMAGE");
+        }
+        try
+        {
+            attach(static_cast<const char *>(_mapped), _size);
+            if (!isConsistent())
+                throw std::logic_error("FROZEN ROADMAP - INVALID IMAGE");
+        }
+        catch (const std::logic_error &)
+        {
+            munmap(_mapped, _size);
+            throw;
+        }
+    }
+
+    FrozenRoadMap::~FrozenRoadMap()
+    {
+        if (_mapped != nullptr)
+            munmap(_mapped, _size);
+    }
+
+    void FrozenRoadMap::attach(const char *data, size_t size)
+    {
+        if (size < sizeof(Header))
+            throw std::logic_error("FROZEN ROADMAP - INVALID IMAGE");
+        const Header &h = *reinterpret_cast<const Header *>(data);
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION || h.curve_size != sizeof(dubins::DubinsCurve))
+            throw std::logic_error("FROZEN ROADMAP - INVALID IMAGE");
+        // Counts are bounded by the size of the image before any product, so that sizes cannot overflow, and IDs must fit below NONE
+        if (h.nodes >= NONE || h.poses >= NONE || h.edges >= NONE || h.nodes > size / sizeof(NodeRecord) ||
+            h.poses > size / sizeof(PoseRecord) || h.edges > size / sizeof(dubins::DubinsCurve))
+            throw std::logic_error("FROZEN ROADMAP - INVALID IMAGE");
+        uint64_t expected[SECTION_COUNT] = {
+            h.nodes * sizeof(NodeRecord), h.poses * sizeof(PoseRecord),
+            (h.poses + 1) * sizeof(edge_id), (h.poses + 1) * sizeof(uint32_t),
+            h.edges * sizeof(pose_id), h.edges * sizeof(pose_id), h.edges * sizeof(float),
+            h.edges * sizeof(dubins::DubinsCurve), h.edges * sizeof(edge_id)};
+        for (size_t s = 0; s < SECTION_COUNT; s++)
+        {
+            if (h.size[s] != expected[s] || h.offset[s] % 8 != 0 || h.offset[s] > size || h.size[s] > size - h.offset[s])
+                throw std::logic_error("FROZEN ROADMAP - INVALID IMAGE");
+        }
+        _node_count = h.nodes;
+        _pose_count = h.poses;
+        _edge_count = h.edges;
+        _nodes = reinterpret_cast<const NodeRecord *>(data + h.offset[NODES]);
+        _poses = reinterpret_cast<const PoseRecord *>(data + h.offset[POSES]);
+        _out_begin = reinterpret_cast<const edge_id *>(data + h.offset[OUT_BEGIN]);
+        _in_begin = reinterpret_cast<const uint32_t *>(data + h.offset[IN_BEGIN]);
+        _edge_from = reinterpret_cast<const pose_id *>(data + h.offset[EDGE_FROM]);
+        _edge_to = reinterpret_cast<const pose_id *>(data + h.offset[EDGE_TO]);
+        _edge_length = reinterpret_cast<const float *>(data + h.offset[EDGE_LENGTH]);
+        _edge_path = reinterpret_cast<const dubins::DubinsCurve *>(data + h.offset[EDGE_PATH]);
+        _in_edge = reinterpret_cast<const edge_id *>(data + h.offset[IN_EDGE]);
+    }
+
+    bool FrozenRoadMap::isConsistent() const
+    {
+        for (RoadMap::node_id node = 0; node < _node_count; node++)
+        {
+            if (_nodes[node].first_pose > _pose_count || _nodes[node].pose_count > _pose_count - _nodes[node].first_pose)
+                return false;
+        }
+        for (pose_id pose = 0; pose < _pose_count; pose++)
+        {
+            if (_poses[pose].node >= _node_count)
+                return false;
+        }
+
+        // Connections are grouped by their first pose, and the incoming ones list every connection once by its last pose
+        if (_out_begin[0] != 0 || _out_begin[_pose_count] != _edge_count || _in_begin[0] != 0 || _in_begin[_pose_count] != _edge_count)
+            return false;
+        for (pose_id pose = 0; pose < _pose_count; pose++)
+        {
+            if (_out_begin[pose] > _out_begin[pose + 1] || _in_begin[pose] > _in_begin[pose + 1])
+                return false;
+            for (edge_id edge = _out_begin[pose]; edge < _out_begin[pose + 1]; edge++)
+            {
+                if (_edge_from[edge] != pose || _edge_to[edge] >= _pose_count || !(_edge_length[edge] >= 0.0f))
+                    return false;
+            }
+            for (uint32_t i = _in_begin[pose]; i < _in_begin[pose + 1]; i++)
+            {
+                if (_in_edge[i] >= _edge_count || _edge_to[_in_edge[i]] != pose)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool FrozenRoadMap::publish(const std::string &file) const
+    {
+        const char *data = _mapped != nullptr ? static_cast<const char *>(_mapped) : _buffer.data();
+        size_t size = _mapped != nullptr ? _size : _buffer.size();
+
+        // Write to a temporary file of this process first, so that readers and other writers never map a partial image
+        std::vector<char> tmp_name(file.begin(), file.end());
+        const char tmp_suffix[] = ".XXXXXX";
+        tmp_name.insert(tmp_name.end(), tmp_suffix, tmp_suffix + sizeof(tmp_suffix));
+        int fd = mkstemp(tmp_name.data());
+        if (fd < 0)
+            return false;
+        const std::string tmp_file(tmp_name.data());
+        fchmod(fd, 0644);
+        size_t written = 0;
+        while (written < size)
+        {
+            ssize_t n = write(fd, data + written, size - written);
+            if (n <= 0)
+                break;
+            written += n;
+        }
+        close(fd);
+        if (written != size)
+        {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+        if (std::rename(tmp_file.c_str(), file.c_str()) != 0)
+        {
+            std::remove(tmp_file.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    const RoadMap *FrozenRoadMap::getRoadMap() const { return _source; }
+
+    const RoadMap::DubinsConnection *FrozenRoadMap::getConnection(edge_id edge) const
+    {
+        return _links.empty() ? nullptr : _links[edge];
+    }
+
+    FrozenRoadMap::pose_id FrozenRoadMap::getPoseID(const RoadMap::Node::Orientation &pose) const
+    {
+        return _nodes[pose.getNode().getID()].first_pose + pose.getID();
+    }
+}
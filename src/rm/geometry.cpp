@@ -1,5 +1,7 @@
 #include "rm/geometry.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace rm
@@ -44,6 +46,18 @@ namespace rm
         return collisionCheck(curve.arc_1, p) || collisionCheck(curve.arc_2, p) || collisionCheck(curve.arc_3, p);
     }
 
+    bool collisionCheck(const dubins::DubinsCurve &curve, const std::vector<Polygon> &obstacles, const Polygon &borders)
+    {
+        if (!borders.empty() && collisionCheck(curve, borders))
+            return true;
+        for (const auto &obst : obstacles)
+        {
+            if (collisionCheck(curve, obst))
+                return true;
+        }
+        return false;
+    }
+
     bool collisionCheck(const float &rho, const Point &center, float th0, float th1, const Segment &s)
     {
         // parameterized equation
@@ -102,6 +116,24 @@ namespace rm
         return false;
     }
 
+    float distance(const Point &p, const Segment &s)
+    {
+        float dx = s.p1.x - s.p0.x;
+        float dy = s.p1.y - s.p0.y;
+        float sqr_length = dx * dx + dy * dy;
+        float t = sqr_length > 0 ? ((p.x - s.p0.x) * dx + (p.y - s.p0.y) * dy) / sqr_length : 0.0f;
+        t = std::max(0.0f, std::min(1.0f, t));
+        return std::hypot(s.p0.x + t * dx - p.x, s.p0.y + t * dy - p.y);
+    }
+
+    float distance(const Point &p, const Polygon &poly)
+    {
+        float out = INFINITY;
+        for (const auto &edge : getEdges(poly))
+            out = std::min(out, distance(p, edge));
+        return out;
+    }
+
     std::vector<Segment> getEdges(const Polygon &p)
     {
         std::vector<Segment> out;
@@ -0,0 +1,211 @@
+#include "rm/lattice.hpp"
+
+#include "rm/geometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+
+namespace rm
+{
+    namespace
+    {
+        dubins::Pose2D toPose2D(float x, float y, float theta)
+        {
+            dubins::Pose2D out;
+            out.x = x;
+            out.y = y;
+            out.theta = theta;
+            return out;
+        }
+
+        void translate(dubins::Pose2D &pose, float x, float y)
+        {
+            pose.x += x;
+            pose.y += y;
+        }
+
+        /**
+         * @brief Move a Dubins path starting from the origin to a given position.
+         */
+        dubins::DubinsCurve translate(dubins::DubinsCurve curve, float x, float y)
+        {
+            for (dubins::DubinsArc *arc : {&curve.arc_1, &curve.arc_2, &curve.arc_3})
+            {
+                translate(arc->start, x, y);
+                translate(arc->end, x, y);
+            }
+            return curve;
+        }
+
+        /**
+         * @brief Even-odd test of a point against a polygon, which holds for any orientation and for non-convex polygons.
+         */
+        bool inside(const Point &p, const Polygon &poly)
+        {
+            bool out = false;
+            for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++)
+            {
+                if ((poly[i].y > p.y) != (poly[j].y > p.y) &&
+                    p.x < poly[j].x + (p.y - poly[j].y) * (poly[i].x - poly[j].x) / (poly[i].y - poly[j].y))
+                    out = !out;
+            }
+            return out;
+        }
+    }
+
+    MotionPrimitives::MotionPrimitives(float spacing, unsigned int headings, unsigned int reach, float kmax, unsigned int resolution, float maxDetour)
+        : _spacing(spacing), _resolution(resolution), _primitives(headings)
+    {
+        if (spacing <= 0.0f || headings == 0 || reach == 0 || resolution == 0)
+            throw std::logic_error("LATTICE - INVALID PARAMETERS");
+        const float cell = getCellSize();
+        const int r = reach;
+
+        for (unsigned int h0 = 0; h0 < headings; h0++)
+        {
+            for (int dx = -r; dx <= r; dx++)
+            {
+                for (int dy = -r; dy <= r; dy++)
+                {
+                    if ((dx == 0 && dy == 0) || dx * dx + dy * dy > r * r)
+                        continue;
+                    const float x = dx * spacing, y = dy * spacing;
+                    for (unsigned int h1 = 0; h1 < headings; h1++)
+                    {
+                        std::set<dubins::DubinsCurve> curves;
+                        dubins::findPaths(curves, toPose2D(0.0f, 0.0f, getHeading(h0)), toPose2D(x, y, getHeading(h1)), kmax);
+                        if (curves.empty() || curves.begin()->L > std::hypot(x, y) + maxDetour)
+                            continue;
+
+                        Primitive primitive;
+                        primitive.dx = dx;
+                        primitive.dy = dy;
+                        primitive.heading = h1;
+                        primitive.path = *curves.begin();
+
+                        // Swept cells, the origin being at the centre of its cell
+                        std::vector<Pose> samples;
+                        float offset = 0.0f;
+                        dubins::discretizeCurve(primitive.path, cell / 4, offset, samples);
+                        samples.push_back(Pose(0.0f, x, y, getHeading(h1), 0.0f));
+                        for (const auto &p : samples)
+                            primitive.footprint.push_back(std::make_pair(int(std::floor(p.x / cell + 0.5f)), int(std::floor(p.y / cell + 0.5f))));
+                        std::sort(primitive.footprint.begin(), primitive.footprint.end());
+                        primitive.footprint.erase(std::unique(primitive.footprint.begin(), primitive.footprint.end()), primitive.footprint.end());
+
+                        _primitives[h0].push_back(primitive);
+                    }
+                }
+            }
+        }
+    }
+
+    float MotionPrimitives::getHeading(unsigned int heading) const
+    {
+        return heading * 2 * M_PI / getHeadingCount();
+    }
+
+    const std::vector<MotionPrimitives::Primitive> &MotionPrimitives::getPrimitives(unsigned int heading) const
+    {
+        return _primitives[heading];
+    }
+
+    size_t MotionPrimitives::getPrimitiveCount() const
+    {
+        size_t count = 0;
+        for (const auto &primitives : _primitives)
+            count += primitives.size();
+        return count;
+    }
+
+    unsigned long buildLattice(RoadMap &roadmap, const MotionPrimitives &primitives, const std::vector<Polygon> &obstacles, const Polygon &borders)
+    {
+        if (borders.empty())
+            throw std::logic_error("LATTICE - EMPTY BORDERS");
+        const float spacing = primitives.getSpacing(), cell = primitives.getCellSize();
+        const int resolution = primitives.getResolution();
+
+        // Lattice positions, centred in the bounding box of the borders
+        float x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY;
+        for (const auto &p : borders)
+        {
+            x0 = std::min(x0, p.x);
+            y0 = std::min(y0, p.y);
+            x1 = std::max(x1, p.x);
+            y1 = std::max(y1, p.y);
+        }
+        const int columns = int((x1 - x0) / spacing) + 1, rows = int((y1 - y0) / spacing) + 1;
+        const float nx0 = x0 + (x1 - x0 - (columns - 1) * spacing) / 2, ny0 = y0 + (y1 - y0 - (rows - 1) * spacing) / 2;
+
+        // Occupancy grid, with a lattice position at the centre of every resolution-th cell.
+        // A cell is free when it is inside the borders and no obstacle lies within a cell from its centre.
+        const int cell_columns = (columns - 1) * resolution + 1, cell_rows = (rows - 1) * resolution + 1;
+        std::vector<bool> occupied(cell_columns * cell_rows);
+        for (int cy = 0; cy < cell_rows; cy++)
+        {
+            for (int cx = 0; cx < cell_columns; cx++)
+            {
+                Point centre(nx0 + cx * cell, ny0 + cy * cell);
+                bool free = inside(centre, borders) && distance(centre, borders) > cell;
+                for (size_t i = 0; i < obstacles.size() && free; i++)
+                    free = !inside(centre, obstacles[i]) && distance(centre, obstacles[i]) > cell;
+                occupied[cy * cell_columns + cx] = !free;
+            }
+        }
+        auto isOccupied = [&](int cx, int cy) {
+            return cx < 0 || cy < 0 || cx >= cell_columns || cy >= cell_rows || occupied[cy * cell_columns + cx];
+        };
+
+        // A node with a pose for each heading on every free position
+        const RoadMap::node_id NONE = -1;
+        std::vector<RoadMap::node_id> node_at(columns * rows, NONE);
+        for (int j = 0; j < rows; j++)
+        {
+            for (int i = 0; i < columns; i++)
+            {
+                if (isOccupied(i * resolution, j * resolution))
+                    continue;
+                node_at[j * columns + i] = roadmap.addNode(Point(nx0 + i * spacing, ny0 + j * spacing));
+                RoadMap::Node &node = roadmap.getNode(node_at[j * columns + i]);
+                for (unsigned int h = 0; h < primitives.getHeadingCount(); h++)
+                    node.addPose(primitives.getHeading(h));
+            }
+        }
+
+        // Connections by footprint lookup
+        unsigned long n_connections = 0L;
+        for (int j = 0; j < rows; j++)
+        {
+            for (int i = 0; i < columns; i++)
+            {
+                if (node_at[j * columns + i] == NONE)
+                    continue;
+                RoadMap::Node &node = roadmap.getNode(node_at[j * columns + i]);
+                for (unsigned int h = 0; h < primitives.getHeadingCount(); h++)
+                {
+                    RoadMap::Node::Orientation &pose = node.getPose(h);
+                    pose.reserve(primitives.getPrimitives(h).size(), primitives.getPrimitives(h).size());
+                    for (const auto &primitive : primitives.getPrimitives(h))
+                    {
+                        int ti = i + primitive.dx, tj = j + primitive.dy;
+                        if (ti < 0 || tj < 0 || ti >= columns || tj >= rows || node_at[tj * columns + ti] == NONE)
+                            continue;
+                        bool free = true;
+                        for (size_t c = 0; c < primitive.footprint.size() && free; c++)
+                            free = !isOccupied(i * resolution + primitive.footprint[c].first, j * resolution + primitive.footprint[c].second);
+                        if (!free)
+                            continue;
+
+                        RoadMap::Node &other = roadmap.getNode(node_at[tj * columns + ti]);
+                        node.connectTo(other.getID());
+                        pose.addConnection(other.getPose(primitive.heading), translate(primitive.path, node.getX(), node.getY()));
+                        n_connections++;
+                    }
+                }
+            }
+        }
+        return n_connections;
+    }
+}
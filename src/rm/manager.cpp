@@ -0,0 +1,79 @@
+#include "rm/manager.hpp"
+
+namespace rm
+{
+    RoadMapManager::RoadMapManager() : _version(0), _building(false) {}
+
+    RoadMapManager::~RoadMapManager()
+    {
+        if (_worker.joinable())
+            _worker.join();
+    }
+
+    bool RoadMapManager::rebuild(Builder builder)
+    {
+        if (_building)
+            return false;
+        // The previous worker has already terminated
+        if (_worker.joinable())
+            _worker.join();
+        _error = nullptr;
+        _building = true;
+        _worker = std::thread(&RoadMapManager::run, this, builder);
+        return true;
+    }
+
+    void RoadMapManager::run(Builder builder)
+    {
+        try
+        {
+            std::shared_ptr<RoadMap> next = std::make_shared<RoadMap>();
+            builder(*next);
+            publish(next);
+        }
+        catch (...)
+        {
+            _error = std::current_exception();
+        }
+        _building = false;
+    }
+
+    void RoadMapManager::publish(std::shared_ptr<RoadMap> roadmap)
+    {
+        // Freeze before the swap, so that readers never pay for it
+        roadmap->freeze();
+        std::atomic_store(&_current, std::shared_ptr<const RoadMap>(roadmap));
+        _version++;
+    }
+
+    void RoadMapManager::wait()
+    {
+        if (_worker.joinable())
+            _worker.join();
+        if (_error)
+        {
+            std::exception_ptr error = _error;
+            _error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool RoadMapManager::isBuilding() const { return _building; }
+
+    unsigned long RoadMapManager::getVersion() const { return _version; }
+
+    std::shared_ptr<const RoadMap> RoadMapManager::getRoadMap() const
+    {
+        return std::atomic_load(&_current);
+    }
+
+    std::shared_ptr<const FrozenRoadMap> RoadMapManager::getGraph() const
+    {
+        std::shared_ptr<const RoadMap> roadmap = getRoadMap();
+        if (!roadmap)
+            return nullptr;
+        // The image refers to the connections of the roadmap, which must outlive it
+        std::shared_ptr<const FrozenRoadMap> graph = roadmap->freeze();
+        return std::shared_ptr<const FrozenRoadMap>(graph.get(), [roadmap, graph](const FrozenRoadMap *) {});
+    }
+}
@@ -0,0 +1,176 @@
+#include "rm/overlay.hpp"
+
+#include "rm/geometry.hpp"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <stdexcept>
+
+namespace rm
+{
+    const std::vector<Overlay::edge_id> Overlay::NO_EDGES;
+
+    namespace
+    {
+        dubins::Pose2D toPose2D(float x, float y, float theta)
+        {
+            dubins::Pose2D out;
+            out.x = x;
+            out.y = y;
+            out.theta = theta;
+            return out;
+        }
+    }
+
+    Overlay::Overlay(std::shared_ptr<const FrozenRoadMap> base)
+        : _base(base), _base_out_mask((base->getPoseCount() + 63) / 64, 0), _base_in_mask((base->getPoseCount() + 63) / 64, 0) {}
+
+    const FrozenRoadMap &Overlay::getBase() const { return *_base; }
+
+    Overlay::pose_id Overlay::addPose(Point pos, float angle)
+    {
+        if (getPoseCount() >= FrozenRoadMap::NONE)
+            throw std::logic_error("OVERLAY - TOO MANY POSES");
+        PoseRecord pose = {pos.x, pos.y, angle};
+        _poses.push_back(pose);
+        _out.push_back(std::vector<edge_id>());
+        _in.push_back(std::vector<edge_id>());
+        return getPoseCount() - 1;
+    }
+
+    Overlay::edge_id Overlay::addEdge(pose_id from, pose_id to, const dubins::DubinsCurve &path)
+    {
+        if (getEdgeCount() >= FrozenRoadMap::NONE)
+            throw std::logic_error("OVERLAY - TOO MANY CONNECTIONS");
+        EdgeRecord edge = {from, to, path};
+        _edges.push_back(edge);
+        return getEdgeCount() - 1;
+    }
+
+    void Overlay::link(edge_id edge)
+    {
+        const EdgeRecord &record = _edges[edge - _base->getEdgeCount()];
+        if (isOverlay(record.from))
+            _out[record.from - _base->getPoseCount()].push_back(edge);
+        else
+            linkBase(_base_out, _base_out_mask, record.from, edge);
+        if (isOverlay(record.to))
+            _in[record.to - _base->getPoseCount()].push_back(edge);
+        else
+            linkBase(_base_in, _base_in_mask, record.to, edge);
+    }
+
+    void Overlay::linkBase(std::vector<BaseEdges> &edges, std::vector<uint64_t> &mask, pose_id pose, edge_id edge)
+    {
+        auto it = std::lower_bound(edges.begin(), edges.end(), pose, [](const BaseEdges &entry, pose_id p) { return entry.pose < p; });
+        if (it == edges.end() || it->pose != pose)
+        {
+            BaseEdges entry;
+            entry.pose = pose;
+            it = edges.insert(it, entry);
+            mask[pose >> 6] |= uint64_t(1) << (pose & 63);
+        }
+        it->edges.push_back(edge);
+    }
+
+    const std::vector<Overlay::edge_id> &Overlay::findBase(const std::vector<BaseEdges> &edges, pose_id pose)
+    {
+        auto it = std::lower_bound(edges.begin(), edges.end(), pose, [](const BaseEdges &entry, pose_id p) { return entry.pose < p; });
+        return it == edges.end() || it->pose != pose ? NO_EDGES : it->edges;
+    }
+
+    std::vector<RoadMap::node_id> Overlay::findKClosest(Point pos, int k, RoadMap::node_id skip) const
+    {
+        typedef std::pair<float, RoadMap::node_id> dist_node;
+        std::set<dist_node> dist_nodes;
+        for (RoadMap::node_id node = 0; node < getNodeCount(); node++)
+        {
+            if (node == skip)
+                continue;
+            pose_id first = getFirstPose(node);
+            float dx = pos.x - (node < _base->getNodeCount() ? _base->getX(node) : getX(first));
+            float dy = pos.y - (node < _base->getNodeCount() ? _base->getY(node) : getY(first));
+            dist_nodes.insert(dist_node(dx * dx + dy * dy, node));
+        }
+        std::vector<RoadMap::node_id> out;
+        for (int i = 0; i < k && !dist_nodes.empty(); i++)
+        {
+            out.push_back(dist_nodes.begin()->second);
+            dist_nodes.erase(dist_nodes.begin());
+        }
+        return out;
+    }
+
+    Overlay::pose_id Overlay::addStartPose(Point pos, float angle, int k, float kmax, const std::vector<Polygon> &obstacles, const Polygon &borders)
+    {
+        pose_id pose = addPose(pos, angle);
+
+        bool ok = false;
+        for (RoadMap::node_id node : findKClosest(pos, k, getNode(pose)))
+        {
+            pose_id first = getFirstPose(node);
+            for (size_t i = 0; i < getPosesCount(node); i++)
+            {
+                std::set<dubins::DubinsCurve> curves;
+                dubins::findPaths(curves, toPose2D(pos.x, pos.y, angle),
+                                  toPose2D(getX(first + i), getY(first + i), getTheta(first + i)), kmax);
+                for (const auto &curve : curves)
+                {
+                    if (collisionCheck(curve, obstacles, borders))
+                        continue;
+                    link(addEdge(pose, first + i, curve));
+                    ok = true;
+                    break;
+                }
+            }
+        }
+        if (!ok)
+            throw std::logic_error("ADD START POSE - UNABLE TO CONNECT TO K-CLOSEST NODES");
+
+        return pose;
+    }
+
+    Overlay::pose_id Overlay::addGoalPose(Point pos, float angle, int k, float kmax, const std::vector<Polygon> &obstacles, const Polygon &borders)
+    {
+        pose_id pose = addPose(pos, angle);
+
+        bool ok = false;
+        for (RoadMap::node_id node : findKClosest(pos, k, getNode(pose)))
+        {
+            pose_id first = getFirstPose(node);
+            for (size_t i = 0; i < getPosesCount(node); i++)
+            {
+                std::set<dubins::DubinsCurve> curves;
+                dubins::findPaths(curves, toPose2D(getX(first + i), getY(first + i), getTheta(first + i)),
+                                  toPose2D(pos.x, pos.y, angle), kmax);
+                for (const auto &curve : curves)
+                {
+                    if (collisionCheck(curve, obstacles, borders))
+                        continue;
+                    link(addEdge(first + i, pose, curve));
+                    ok = true;
+                    break;
+                }
+            }
+        }
+        if (!ok)
+            throw std::logic_error("ADD GOAL POSE - UNABLE TO CONNECT FROM K-CLOSEST NODES");
+
+        return pose;
+    }
+
+    Overlay::edge_id Overlay::addWait(pose_id pose, float length)
+    {
+        dubins::DubinsCurve wait_path = dubins::DubinsCurve();
+        wait_path.L = length;
+        return addEdge(pose, pose, wait_path);
+    }
+
+    Overlay::edge_id Overlay::addPath(pose_id from, const dubins::DubinsCurve &path, pose_id to)
+    {
+        if (to == FrozenRoadMap::NONE)
+            to = addPose(Point(path.arc_3.end.x, path.arc_3.end.y), path.arc_3.end.theta);
+        return addEdge(from, to, path);
+    }
+}
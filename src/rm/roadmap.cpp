@@ -1,16 +1,137 @@
 #include "rm/roadmap.hpp"
 
 #include "rm/geometry.hpp"
+#include "rm/frozen.hpp"
 
 #include <cmath>
 #include <utility>
 #include <set>
+#include <queue>
 #include <limits>
+#include <algorithm>
 #include <stdexcept>
 
 namespace rm
 {
+    namespace
+    {
+        // Axis-aligned bounding box
+        struct Box
+        {
+            float x0, y0, x1, y1;
+        };
+
+        Box boundingBox(const Polygon &polygon)
+        {
+            Box box = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+            for (const auto &p : polygon)
+            {
+                box.x0 = std::min(box.x0, p.x);
+                box.y0 = std::min(box.y0, p.y);
+                box.x1 = std::max(box.x1, p.x);
+                box.y1 = std::max(box.y1, p.y);
+            }
+            return box;
+        }
+
+        // Each point of an arc is closer than half the arc length to one of its ends
+        Box boundingBox(const dubins::DubinsCurve &curve)
+        {
+            Box box = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+            for (const dubins::DubinsArc *arc : {&curve.arc_1, &curve.arc_2, &curve.arc_3})
+            {
+                float margin = 0.5f * arc->s;
+                box.x0 = std::min(box.x0, std::min(arc->start.x, arc->end.x) - margin);
+                box.y0 = std::min(box.y0, std::min(arc->start.y, arc->end.y) - margin);
+                box.x1 = std::max(box.x1, std::max(arc->start.x, arc->end.x) + margin);
+                box.y1 = std::max(box.y1, std::max(arc->start.y, arc->end.y) + margin);
+            }
+            return box;
+        }
+
+        Box boundingBox(const Point &p0, const Point &p1)
+        {
+            Box box = {std::min(p0.x, p1.x), std::min(p0.y, p1.y), std::max(p0.x, p1.x), std::max(p0.y, p1.y)};
+            return box;
+        }
+
+        bool overlaps(const Box &b0, const Box &b1)
+        {
+            return b0.x0 <= b1.x1 && b1.x0 <= b0.x1 && b0.y0 <= b1.y1 && b1.y0 <= b0.y1;
+        }
+
+        float distance(const Point &p, const Box &box)
+        {
+            float dx = std::max(std::max(box.x0 - p.x, p.x - box.x1), 0.0f);
+            float dy = std::max(std::max(box.y0 - p.y, p.y - box.y1), 0.0f);
+            return std::hypot(dx, dy);
+        }
+
+        bool samePolygon(const Polygon &p0, const Polygon &p1)
+        {
+            if (p0.size() != p1.size())
+                return false;
+            for (size_t i = 0; i < p0.size(); i++)
+            {
+                if (p0[i].x != p1[i].x || p0[i].y != p1[i].y)
+                    return false;
+            }
+            return true;
+        }
+
+        // Same rule as rm::visibility()
+        bool visible(const Point &p0, const Point &p1, const std::vector<Polygon> &obstacles, const Polygon &borders)
+        {
+            Segment s(p0, p1);
+            if (!borders.empty() && collisionCheck(s, borders))
+                return false;
+            for (const Polygon &obst : obstacles)
+            {
+                if (collisionCheck(p0, obst) || collisionCheck(p1, obst) || collisionCheck(s, obst))
+                    return false;
+            }
+            return true;
+        }
+
+        // Exact check against the polygons whose bounding box overlaps the one of the segment
+        bool blocks(const std::vector<Polygon> &polygons, const std::vector<Box> &boxes, const Point &p0, const Point &p1)
+        {
+            Box box = boundingBox(p0, p1);
+            Segment s(p0, p1);
+            for (size_t i = 0; i < polygons.size(); i++)
+            {
+                if (overlaps(box, boxes[i]) &&
+                    (collisionCheck(p0, polygons[i]) || collisionCheck(p1, polygons[i]) || collisionCheck(s, polygons[i])))
+                    return true;
+            }
+            return false;
+        }
+
+        // Exact check against the polygons whose bounding box overlaps the one of the curve
+        bool blocks(const std::vector<Polygon> &polygons, const std::vector<Box> &boxes, const dubins::DubinsCurve &curve)
+        {
+            Box box = boundingBox(curve);
+            for (size_t i = 0; i < polygons.size(); i++)
+            {
+                if (overlaps(box, boxes[i]) && collisionCheck(curve, polygons[i]))
+                    return true;
+            }
+            return false;
+        }
+
+        dubins::Pose2D toPose2D(const RoadMap::Node::Orientation &pose)
+        {
+            dubins::Pose2D out;
+            out.x = pose.getNode().getX();
+            out.y = pose.getNode().getY();
+            out.theta = pose.getTheta();
+            return out;
+        }
+    }
+
     // RoadMap
+    RoadMap::RoadMap() : _arena(new Arena()), _nodes(ArenaAllocator<Node>(_arena.get())), _states(ArenaAllocator<ConnectionState>(_arena.get())) {}
+
     RoadMap::node_id RoadMap::addNode(Point pos)
     {
         // Check if node exists
@@ -22,6 +143,7 @@ namespace rm
 
         node_id id = _nodes.size();
         _nodes.push_back(Node(this, id, pos));
+        touch();
         return id;
     }
 
@@ -129,67 +251,730 @@ namespace rm
         return pose;
     }
 
-    unsigned long RoadMap::build(unsigned int orientationsPerNode, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders)
+    unsigned long RoadMap::build(unsigned int orientationsPerNode, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders, bool lazy)
+    {
+        _lazy = lazy;
+        _orientations = orientationsPerNode;
+        _min_orientations = 0;
+        _kmax = kmax;
+        _obstacles = obstacles;
+        _borders = borders;
+        return buildGraph();
+    }
+
+    unsigned long RoadMap::buildAdaptive(unsigned int minOrientations, unsigned int maxOrientations, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders, bool lazy)
+    {
+        if (minOrientations < 2 || maxOrientations < minOrientations)
+            throw std::logic_error("ROADMAP - INVALID NUMBER OF ORIENTATIONS");
+        _lazy = lazy;
+        _orientations = maxOrientations;
+        _min_orientations = minOrientations;
+        _kmax = kmax;
+        _obstacles = obstacles;
+        _borders = borders;
+        return buildGraph();
+    }
+
+    std::vector<float> RoadMap::makeHeadings(const Node &node) const
+    {
+        std::vector<float> headings;
+        if (_min_orientations == 0 || node.getConnectedCount() == 0)
+        {
+            // Evenly spaced headings
+            unsigned int count = _min_orientations == 0 ? _orientations : _min_orientations;
+            float theta = 2 * M_PI / count;
+            for (unsigned int i = 0; i < count; i++)
+                headings.push_back(theta * i);
+            return headings;
+        }
+
+        // Headings of the straight paths leaving the node along its visibility edges, or arriving through them
+        std::vector<float> directions;
+        for (size_t i = 0; i < node.getConnectedCount(); i++)
+        {
+            const Node &other = node.getConnected(i);
+            float theta = std::atan2(other.getY() - node.getY(), other.getX() - node.getX());
+            directions.push_back(dubins::mod2pi(theta));
+            directions.push_back(dubins::mod2pi(theta + M_PI));
+        }
+        std::sort(directions.begin(), directions.end());
+
+        // Unroll the directions starting after the widest gap, so that no group wraps around
+        size_t first = 0;
+        float widest = 0.0f;
+        for (size_t i = 0; i < directions.size(); i++)
+        {
+            float gap = (i + 1 < directions.size() ? directions[i + 1] : directions[0] + 2 * M_PI) - directions[i];
+            if (gap > widest)
+            {
+                widest = gap;
+                first = (i + 1) % directions.size();
+            }
+        }
+        std::rotate(directions.begin(), directions.begin() + first, directions.end());
+        for (size_t i = 1; i < directions.size(); i++)
+        {
+            if (directions[i] < directions[i - 1])
+                directions[i] += 2 * M_PI;
+        }
+
+        // Close to obstacles there is no room to correct the heading, so only almost parallel directions are merged.
+        // Room is measured in turning radii.
+        Point pos(node.getX(), node.getY());
+        float clearance = _borders.empty() ? INFINITY : distance(pos, _borders);
+        for (const auto &obst : _obstacles)
+            clearance = std::min(clearance, distance(pos, obst));
+        float room = std::min(1.0f, clearance * _kmax);
+        float resolution = 2 * M_PI / _orientations + room * (2 * M_PI / _min_orientations - 2 * M_PI / _orientations);
+
+        // Each group of directions within the resolution gives the heading in its middle
+        do
+        {
+            headings.clear();
+            size_t begin = 0;
+            for (size_t i = 1; i <= directions.size(); i++)
+            {
+                if (i < directions.size() && directions[i] - directions[begin] <= resolution)
+                    continue;
+                headings.push_back(dubins::mod2pi(0.5f * (directions[begin] + directions[i - 1])));
+                begin = i;
+            }
+            resolution *= 1.25f;
+        } while (headings.size() > _orientations);
+
+        // Fill the widest gaps up to the minimum number of headings
+        std::sort(headings.begin(), headings.end());
+        while (headings.size() < _min_orientations)
+        {
+            size_t widest_idx = 0;
+            widest = 0.0f;
+            for (size_t i = 0; i < headings.size(); i++)
+            {
+                float gap = (i + 1 < headings.size() ? headings[i + 1] : headings[0] + 2 * M_PI) - headings[i];
+                if (gap > widest)
+                {
+                    widest = gap;
+                    widest_idx = i;
+                }
+            }
+            headings.insert(headings.begin() + widest_idx + 1, dubins::mod2pi(headings[widest_idx] + 0.5f * widest));
+            std::sort(headings.begin(), headings.end());
+        }
+        return headings;
+    }
+
+    bool RoadMap::isBuilt(const Node &node) const
+    {
+        // Start and goal nodes hold a single pose
+        if (_min_orientations == 0)
+            return node.getPosesCount() == _orientations;
+        return node.getPosesCount() >= _min_orientations;
+    }
+
+    unsigned long RoadMap::buildGraph()
     {
         unsigned long n_connections = 0L;
+        const bool lazy = _lazy;
+        const float kmax = _kmax;
+        const std::vector<Polygon> &obstacles = _obstacles;
+        const Polygon &borders = _borders;
+
+        // Choose the poses of each node
+        std::vector<std::vector<float>> headings;
+        headings.reserve(_nodes.size());
+        for (const Node &node : _nodes)
+            headings.push_back(makeHeadings(node));
+
+        // Count the storage of the base graph and of the poses. Each pose is connected at most once to each pose of a connected node,
+        // which is the exact count in lazy mode. The connection lists are reserved once their exact size is known.
+        std::vector<size_t> first_pose(_nodes.size() + 1, 0);
+        for (node_id id = 0; id < _nodes.size(); id++)
+            first_pose[id + 1] = first_pose[id] + headings[id].size();
+        size_t n_links = 0, max_connections = 0;
+        for (const Node &node : _nodes)
+        {
+            n_links += node.getConnectedCount();
+            for (size_t i = 0; i < node.getConnectedCount(); i++)
+                max_connections += headings[node.getID()].size() * headings[node.getConnected(i).getID()].size();
+        }
+        const size_t n_poses = first_pose[_nodes.size()];
+        size_t bytes = _nodes.size() * sizeof(Node) + n_links * sizeof(node_id) + n_poses * sizeof(Node::Orientation) + max_connections * sizeof(ConnectionState);
+        // Padding of every vector
+        bytes += (2 * _nodes.size() + 2) * alignof(DubinsConnection);
+
+        // Move the base graph to a new arena, the previous one is released with the poses of the previous build
+        std::unique_ptr<Arena> previous = std::move(_arena);
+        _arena.reset(new Arena(bytes));
+        ArenaVector<Node> nodes = ArenaVector<Node>(ArenaAllocator<Node>(_arena.get()));
+        nodes.reserve(_nodes.size());
+        for (const Node &node : _nodes)
+        {
+            nodes.push_back(Node(this, node.getID(), node._pos));
+            nodes.back()._connected.assign(node._connected.begin(), node._connected.end());
+        }
+        _nodes = std::move(nodes);
+        _states = ArenaVector<ConnectionState>(ArenaAllocator<ConnectionState>(_arena.get()));
+        _states.reserve(max_connections);
+        touch();
+
         // Generate poses for each node
         for (RoadMap::node_id id : _nodes)
         {
             Node &node = _nodes[id];
-            node.clearPoses();
-            float theta = 2 * M_PI / orientationsPerNode;
-            for (unsigned int i = 0; i < orientationsPerNode; i++)
+            node._poses.reserve(headings[id].size());
+            for (float theta : headings[id])
             {
-                node.addPose(theta * i);
+                node.addPose(theta);
             }
         }
 
-        // Try to connect each pose of a node to each pose of another connected node
+        // Try to connect each pose of a node to each pose of another connected node.
+        // The connections are collected first, so that every list is allocated once with its exact size, in a single block.
+        std::vector<DubinsConnection> connections;
+        std::vector<size_t> first_connection(n_poses + 1, 0);
+        std::vector<size_t> n_from(n_poses, 0);
         for (RoadMap::node_id id : _nodes)
         {
             Node &node = _nodes[id];
 
-            //iterate over connected nodes
-            for (size_t other_idx = 0; other_idx < node.getConnectedCount(); other_idx++)
+            //iterate over poses
+            for (size_t pose_idx = 0; pose_idx < node.getPosesCount(); pose_idx++)
             {
-                Node &other = node.getConnected(other_idx);
+                Node::Orientation &pose = node.getPose(pose_idx);
 
-                //iterate over poses
-                for (size_t pose_idx = 0; pose_idx < node.getPosesCount(); pose_idx++)
+                //iterate over connected nodes
+                for (size_t other_idx = 0; other_idx < node.getConnectedCount(); other_idx++)
                 {
-                    Node::Orientation &pose = node.getPose(pose_idx);
+                    Node &other = node.getConnected(other_idx);
 
                     //iterate over poses of connected node
                     for (size_t pose_other_idx = 0; pose_other_idx < other.getPosesCount(); pose_other_idx++)
                     {
                         Node::Orientation &pose_other = other.getPose(pose_other_idx);
 
-                        if (pose.connect(pose_other, kmax, obstacles, borders))
-                            n_connections++;
+                        // Same paths as Orientation::connect() and Orientation::connectUnchecked()
+                        std::set<dubins::DubinsCurve> curves;
+                        dubins::findPaths(curves, toPose2D(pose), toPose2D(pose_other), kmax);
+                        for (const auto &curve : curves)
+                        {
+                            if (!lazy && collisionCheck(curve, obstacles, borders))
+                                continue;
+                            connections.push_back(DubinsConnection(&pose, &pose_other, curve, addConnectionState(lazy ? UNCHECKED : VALID)));
+                            n_from[first_pose[other.getID()] + pose_other_idx]++;
+                            break;
+                        }
+                    }
+                }
+                first_connection[first_pose[id] + pose_idx + 1] = connections.size();
+            }
+        }
+        n_connections = connections.size();
+
+        // Store each connection in the list of its source pose and in the one of its destination pose, in the same order as connect() does
+        _arena->reserve(2 * n_connections * sizeof(DubinsConnection) + 2 * n_poses * alignof(DubinsConnection));
+        for (RoadMap::node_id id : _nodes)
+        {
+            for (size_t pose_idx = 0; pose_idx < _nodes[id].getPosesCount(); pose_idx++)
+            {
+                const size_t pose = first_pose[id] + pose_idx;
+                _nodes[id].getPose(pose_idx)._connections.assign(connections.begin() + first_connection[pose], connections.begin() + first_connection[pose + 1]);
+            }
+        }
+        for (RoadMap::node_id id : _nodes)
+        {
+            for (size_t pose_idx = 0; pose_idx < _nodes[id].getPosesCount(); pose_idx++)
+                _nodes[id].getPose(pose_idx)._from.reserve(n_from[first_pose[id] + pose_idx]);
+        }
+        for (const Node &node : _nodes)
+        {
+            for (size_t pose_idx = 0; pose_idx < node.getPosesCount(); pose_idx++)
+            {
+                const Node::Orientation &pose = node.getPose(pose_idx);
+                for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                    pose.getConnection(c).to->_from.push_back(pose.getConnection(c));
+            }
+        }
+        return n_connections;
+    }
+
+    unsigned long RoadMap::update(const std::vector<Polygon> &added, const std::vector<Polygon> &removed, const std::vector<Point> &vertices)
+    {
+        if (_orientations == 0)
+            throw std::logic_error("ROADMAP - UPDATE REQUIRES A BUILT ROADMAP");
+
+        // Update the obstacle list
+        for (const auto &obst : removed)
+        {
+            auto it = _obstacles.begin();
+            while (it != _obstacles.end() && !samePolygon(*it, obst))
+                it++;
+            if (it == _obstacles.end())
+                throw std::logic_error("ROADMAP - REMOVED OBSTACLE NOT FOUND");
+            _obstacles.erase(it);
+        }
+        _obstacles.insert(_obstacles.end(), added.begin(), added.end());
+        touch();
+
+        std::vector<Box> added_boxes, removed_boxes;
+        for (const auto &obst : added)
+            added_boxes.push_back(boundingBox(obst));
+        for (const auto &obst : removed)
+            removed_boxes.push_back(boundingBox(obst));
+
+        unsigned long n_connections = 0L;
+        const size_t n_nodes = _nodes.size();
+        std::vector<std::pair<node_id, node_id>> new_links;
+
+        // Remove the visibility edges crossing the added obstacles, together with their connections
+        for (Node &node : _nodes)
+        {
+            Point p0(node.getX(), node.getY());
+            for (size_t i = 0; i < node.getConnectedCount();)
+            {
+                Node &other = node.getConnected(i);
+                if (!blocks(added, added_boxes, p0, Point(other.getX(), other.getY())))
+                {
+                    i++;
+                    continue;
+                }
+                for (size_t j = 0; j < node.getPosesCount(); j++)
+                {
+                    Node::Orientation &pose = node.getPose(j);
+                    for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                    {
+                        const DubinsConnection &connection = pose.getConnection(c);
+                        if (&connection.to->getNode() == &other && connection.id < _states.size())
+                            _states[connection.id] = INVALID;
+                    }
+                }
+                node.disconnectFrom(other.getID());
+            }
+        }
+
+        // Invalidate the connections colliding with the added obstacles.
+        // Connections that were blocked by the removed obstacles are checked again on demand in lazy mode.
+        std::vector<std::pair<Node::Orientation *, Node::Orientation *>> to_reconnect;
+        for (Node &node : _nodes)
+        {
+            for (size_t j = 0; j < node.getPosesCount(); j++)
+            {
+                Node::Orientation &pose = node.getPose(j);
+                for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                {
+                    const DubinsConnection &connection = pose.getConnection(c);
+                    if (connection.id >= _states.size())
+                        continue;
+                    ConnectionState &state = _states[connection.id];
+                    if (state == INVALID)
+                    {
+                        if (_lazy && blocks(removed, removed_boxes, connection.path) && node.isConnectedTo(connection.to->getNode()))
+                            state = UNCHECKED;
+                    }
+                    else if (blocks(added, added_boxes, connection.path))
+                    {
+                        state = INVALID;
+                        if (!_lazy)
+                            to_reconnect.push_back(std::make_pair(connection.from, connection.to));
+                    }
+                }
+            }
+        }
+
+        // Look for the next feasible Dubins path of the invalidated connections
+        for (const auto &poses : to_reconnect)
+        {
+            if (poses.first->connect(*poses.second, _kmax, _obstacles, _borders))
+                n_connections++;
+        }
+
+        if (!removed.empty())
+        {
+            // Look for feasible Dubins paths shorter than the stored ones. Such a path was blocked by a removed obstacle if it collides with it.
+            // Any Dubins path between two nodes is shorter than their distance plus three full turns and a diameter.
+            const float reach = (6 * M_PI + 2) / _kmax;
+            for (node_id i = 0; i < n_nodes && !_lazy; i++)
+            {
+                Node &node = _nodes[i];
+                Point p0(node.getX(), node.getY());
+                for (size_t other_idx = 0; other_idx < node.getConnectedCount(); other_idx++)
+                {
+                    Node &other = node.getConnected(other_idx);
+                    Point p1(other.getX(), other.getY());
+                    float max_length = std::hypot(p1.x - p0.x, p1.y - p0.y) + reach;
+                    bool near = false;
+                    for (const auto &box : removed_boxes)
+                        near = near || distance(p0, box) + distance(p1, box) <= max_length;
+                    if (!near)
+                        continue;
+
+                    for (size_t pose_idx = 0; pose_idx < node.getPosesCount(); pose_idx++)
+                    {
+                        Node::Orientation &pose = node.getPose(pose_idx);
+                        for (size_t pose_other_idx = 0; pose_other_idx < other.getPosesCount(); pose_other_idx++)
+                        {
+                            Node::Orientation &pose_other = other.getPose(pose_other_idx);
+                            const DubinsConnection *current = nullptr;
+                            for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                            {
+                                if (pose.getConnection(c).to == &pose_other && getState(pose.getConnection(c)) != INVALID)
+                                    current = &pose.getConnection(c);
+                            }
+
+                            // A path through a removed obstacle is longer than the distance of the obstacle from both poses
+                            if (current != nullptr)
+                            {
+                                bool reachable = false;
+                                for (const auto &box : removed_boxes)
+                                    reachable = reachable || distance(p0, box) + distance(p1, box) < current->path.L;
+                                if (!reachable)
+                                    continue;
+                            }
+
+                            std::set<dubins::DubinsCurve> curves;
+                            dubins::findPaths(curves, toPose2D(pose), toPose2D(pose_other), _kmax);
+                            for (const auto &curve : curves)
+                            {
+                                if (current != nullptr && !(curve < current->path))
+                                    break;
+                                if (!blocks(removed, removed_boxes, curve) || collisionCheck(curve, _obstacles, _borders))
+                                    continue;
+                                if (current != nullptr)
+                                    _states[current->id] = INVALID;
+                                pose.addConnection(pose_other, curve);
+                                n_connections++;
+                                break;
+                            }
+                        }
                     }
                 }
             }
+
+            // Add the visibility edges that were blocked by the removed obstacles
+            for (node_id i = 0; i < n_nodes; i++)
+            {
+                Point p0(_nodes[i].getX(), _nodes[i].getY());
+                for (node_id j = i + 1; j < n_nodes; j++)
+                {
+                    Point p1(_nodes[j].getX(), _nodes[j].getY());
+                    if (!isBuilt(_nodes[i]) || !isBuilt(_nodes[j]) ||
+                        !blocks(removed, removed_boxes, p0, p1) || !visible(p0, p1, _obstacles, _borders))
+                        continue;
+                    if (_nodes[i].connectTo(j))
+                        new_links.push_back(std::make_pair(i, j));
+                    if (_nodes[j].connectTo(i))
+                        new_links.push_back(std::make_pair(j, i));
+                }
+            }
+        }
+
+        // Add new vertices with their visibility edges, then their poses, which may depend on the edges
+        _nodes.reserve(_nodes.size() + vertices.size());
+        const size_t first_new = _nodes.size();
+        for (const auto &v : vertices)
+        {
+            bool free = true;
+            for (const auto &obst : _obstacles)
+                free = free && !collisionCheck(v, obst);
+            size_t count = _nodes.size();
+            if (!free || addNode(v) < count)
+                continue;
+            Node &node = _nodes.back();
+            for (node_id other = 0; other < node.getID(); other++)
+            {
+                if ((other < first_new && !isBuilt(_nodes[other])) ||
+                    !visible(v, Point(_nodes[other].getX(), _nodes[other].getY()), _obstacles, _borders))
+                    continue;
+                if (node.connectTo(other))
+                    new_links.push_back(std::make_pair(node.getID(), other));
+                if (_nodes[other].connectTo(node.getID()))
+                    new_links.push_back(std::make_pair(other, node.getID()));
+            }
+        }
+        for (node_id id = first_new; id < _nodes.size(); id++)
+        {
+            for (float theta : makeHeadings(_nodes[id]))
+                _nodes[id].addPose(theta);
+        }
+
+        // Connect the poses of the new visibility edges
+        for (const auto &link : new_links)
+        {
+            Node &node = _nodes[link.first];
+            Node &other = _nodes[link.second];
+            for (size_t pose_idx = 0; pose_idx < node.getPosesCount(); pose_idx++)
+            {
+                Node::Orientation &pose = node.getPose(pose_idx);
+                for (size_t pose_other_idx = 0; pose_other_idx < other.getPosesCount(); pose_other_idx++)
+                {
+                    Node::Orientation &pose_other = other.getPose(pose_other_idx);
+                    bool ok = _lazy ? pose.connectUnchecked(pose_other, _kmax)
+                                    : pose.connect(pose_other, _kmax, _obstacles, _borders);
+                    if (ok)
+                        n_connections++;
+                }
+            }
         }
+
+        compact();
         return n_connections;
     }
 
+    unsigned long RoadMap::prune()
+    {
+        // Global index of the first pose of each node
+        std::vector<size_t> first_pose(_nodes.size() + 1, 0);
+        for (node_id id = 0; id < _nodes.size(); id++)
+            first_pose[id + 1] = first_pose[id] + _nodes[id].getPosesCount();
+        auto index = [&](const Node::Orientation *pose) { return first_pose[pose->getNode().getID()] + pose->getID(); };
+        auto isValid = [&](const DubinsConnection &connection) { return connection.id < _states.size() && _states[connection.id] == VALID; };
+
+        // Distances from the current pose, within the length of its longest connection
+        std::vector<float> dist(first_pose.back(), INFINITY);
+        std::vector<size_t> reached;
+        typedef std::pair<float, const Node::Orientation *> entry;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+        std::vector<size_t> dominated;
+        for (Node &node : _nodes)
+        {
+            for (size_t pose_idx = 0; pose_idx < node.getPosesCount(); pose_idx++)
+            {
+                Node::Orientation &pose = node.getPose(pose_idx);
+                float bound = 0.0f;
+                for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                {
+                    if (isValid(pose.getConnection(c)))
+                        bound = std::max(bound, pose.getConnection(c).path.L);
+                }
+                if (bound == 0.0f)
+                    continue;
+
+                dist[index(&pose)] = 0.0f;
+                reached.push_back(index(&pose));
+                queue.push(entry(0.0f, &pose));
+                while (!queue.empty())
+                {
+                    entry top = queue.top();
+                    queue.pop();
+                    if (top.first > dist[index(top.second)])
+                        continue;
+                    for (size_t c = 0; c < top.second->getConnectionCount(); c++)
+                    {
+                        const DubinsConnection &connection = top.second->getConnection(c);
+                        float d = top.first + connection.path.L;
+                        if (d > bound || d >= dist[index(connection.to)] || !isValid(connection))
+                            continue;
+                        if (std::isinf(dist[index(connection.to)]))
+                            reached.push_back(index(connection.to));
+                        dist[index(connection.to)] = d;
+                        queue.push(entry(d, connection.to));
+                    }
+                }
+
+                // A connection is dominated by a route reaching its destination through another pose
+                for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                {
+                    const DubinsConnection &connection = pose.getConnection(c);
+                    if (!isValid(connection))
+                        continue;
+                    const Node::Orientation &to = *connection.to;
+                    for (size_t f = 0; f < to.getFromConnectionCount(); f++)
+                    {
+                        const DubinsConnection &last = to.getFromConnection(f);
+                        if (last.from != &pose && dist[index(last.from)] + last.path.L <= connection.path.L && isValid(last))
+                        {
+                            dominated.push_back(connection.id);
+                            break;
+                        }
+                    }
+                }
+
+                for (size_t i : reached)
+                    dist[i] = INFINITY;
+                reached.clear();
+            }
+        }
+
+        // Connections are removed at the end, so that each one is compared with the full graph
+        for (size_t id : dominated)
+            _states[id] = INVALID;
+        if (!dominated.empty())
+            touch();
+        return dominated.size();
+    }
+
+    bool RoadMap::isLazy() const { return _lazy; }
+
+    size_t RoadMap::addConnectionState(ConnectionState state)
+    {
+        touch();
+        _states.push_back(state);
+        return _states.size() - 1;
+    }
+
+    void RoadMap::touch()
+    {
+        _frozen.reset();
+    }
+
+    void RoadMap::compact()
+    {
+        // Invalid connections are only kept in lazy mode, where an update removing obstacles checks them again
+        auto isKept = [&](const DubinsConnection &connection) { return _lazy || connection.id >= _states.size() || _states[connection.id] != INVALID; };
+
+        // Storage of the lists in use, counted as in buildGraph()
+        size_t n_links = 0, n_poses = 0, n_connections = 0, n_states = 0;
+        for (const Node &node : _nodes)
+        {
+            n_links += node._connected.size();
+            n_poses += node._poses.size();
+            for (const Node::Orientation &pose : node._poses)
+            {
+                for (const DubinsConnection &connection : pose._connections)
+                    n_connections += isKept(connection) ? 2 : 0;
+            }
+        }
+        for (ConnectionState state : _states)
+            n_states += _lazy || state != INVALID;
+        size_t bytes = _nodes.size() * sizeof(Node) + n_links * sizeof(node_id) + n_poses * sizeof(Node::Orientation) +
+                       n_connections * sizeof(DubinsConnection) + n_states * sizeof(ConnectionState);
+        bytes += (2 * _nodes.size() + 2 * n_poses + 2) * alignof(DubinsConnection);
+
+        // Lists that grew and invalidated connections are left behind in the arena, which is only released as a whole
+        if (_arena->getUsed() <= 2 * bytes)
+            return;
+
+        std::unique_ptr<Arena> previous = std::move(_arena);
+        _arena.reset(new Arena(bytes));
+        ArenaVector<Node> nodes = ArenaVector<Node>(ArenaAllocator<Node>(_arena.get()));
+        nodes.reserve(_nodes.size());
+        for (const Node &node : _nodes)
+        {
+            nodes.push_back(Node(this, node.getID(), node._pos));
+            Node &copy = nodes.back();
+            copy._connected.assign(node._connected.begin(), node._connected.end());
+            copy._poses.reserve(node._poses.size());
+            for (const Node::Orientation &pose : node._poses)
+                copy._poses.push_back(Node::Orientation(&copy, pose._id, pose._theta));
+        }
+
+        // Kept connections are numbered again in the state table
+        ArenaVector<ConnectionState> states = ArenaVector<ConnectionState>(ArenaAllocator<ConnectionState>(_arena.get()));
+        states.reserve(n_states);
+        std::vector<size_t> ids(_states.size(), -1);
+        for (size_t id = 0; id < _states.size(); id++)
+        {
+            if (_lazy || _states[id] != INVALID)
+            {
+                ids[id] = states.size();
+                states.push_back(_states[id]);
+            }
+        }
+        auto getID = [&](const DubinsConnection &connection) { return connection.id < ids.size() ? ids[connection.id] : connection.id; };
+
+        // Connections point to the poses of the new nodes, and are listed by their destination in the same order
+        auto getCopy = [&](const Node::Orientation *pose) { return &nodes[pose->getNode().getID()]._poses[pose->_id]; };
+        for (const Node &node : _nodes)
+        {
+            for (const Node::Orientation &pose : node._poses)
+            {
+                Node::Orientation &copy = *getCopy(&pose);
+                size_t kept = 0, kept_from = 0;
+                for (const DubinsConnection &connection : pose._connections)
+                    kept += isKept(connection);
+                for (const DubinsConnection &connection : pose._from)
+                    kept_from += isKept(connection);
+                copy._connections.reserve(kept);
+                copy._from.reserve(kept_from);
+                for (const DubinsConnection &connection : pose._connections)
+                {
+                    if (isKept(connection))
+                        copy._connections.push_back(DubinsConnection(&copy, getCopy(connection.to), connection.path, getID(connection)));
+                }
+                for (const DubinsConnection &connection : pose._from)
+                {
+                    if (isKept(connection))
+                        copy._from.push_back(DubinsConnection(getCopy(connection.from), &copy, connection.path, getID(connection)));
+                }
+            }
+        }
+
+        _nodes = std::move(nodes);
+        _states = std::move(states);
+        touch();
+    }
+
+    std::shared_ptr<const FrozenRoadMap> RoadMap::freeze() const
+    {
+        std::lock_guard<std::mutex> lock(_frozen_mutex);
+        if (!_frozen)
+            _frozen = std::make_shared<FrozenRoadMap>(*this);
+        return _frozen;
+    }
+
+    RoadMap::ConnectionState RoadMap::getState(const DubinsConnection &connection) const
+    {
+        return getState(connection.id);
+    }
+
+    RoadMap::ConnectionState RoadMap::getState(size_t id) const
+    {
+        if (id >= _states.size())
+            return VALID;
+        return _states[id];
+    }
+
+    bool RoadMap::validate(const DubinsConnection &connection) const
+    {
+        if (getState(connection) == UNCHECKED)
+            _states[connection.id] = collisionCheck(connection.path, _obstacles, _borders) ? INVALID : VALID;
+        return getState(connection) == VALID;
+    }
+
     // Node
-    RoadMap::Node::Node(RoadMap *parent, node_id id, Point pos) : _pos(pos), _id(id), _parent(parent) {}
+    RoadMap::Node::Node(RoadMap *parent, node_id id, Point pos)
+        : _parent(parent), _id(id), _pos(pos), _poses(ArenaAllocator<Orientation>(parent->_arena.get())),
+          _connected(ArenaAllocator<node_id>(parent->_arena.get())) {}
+
+    RoadMap::Node::Node(Node &&other) noexcept
+        : _parent(other._parent), _id(other._id), _pos(other._pos), _poses(std::move(other._poses)), _connected(std::move(other._connected))
+    {
+        for (Orientation &pose : _poses)
+            pose._parent = this;
+    }
+
+    RoadMap::Node &RoadMap::Node::operator=(Node &&other) noexcept
+    {
+        _pos = other._pos;
+        _id = other._id;
+        _parent = other._parent;
+        _poses = std::move(other._poses);
+        _connected = std::move(other._connected);
+        for (Orientation &pose : _poses)
+            pose._parent = this;
+        return *this;
+    }
+
     float RoadMap::Node::getX() const { return _pos.x; }
     float RoadMap::Node::getY() const { return _pos.y; }
     RoadMap::node_id RoadMap::Node::getID() const { return _id; }
     size_t RoadMap::Node::getPosesCount() const { return _poses.size(); }
-    void RoadMap::Node::clearPoses() { _poses.clear(); }
+    void RoadMap::Node::clearPoses()
+    {
+        _poses.clear();
+        _parent->touch();
+    }
     RoadMap::Node::Orientation &RoadMap::Node::getPose(size_t index) { return _poses[index]; }
     const RoadMap::Node::Orientation &RoadMap::Node::getPose(size_t index) const { return _poses[index]; }
     size_t RoadMap::Node::getConnectedCount() const { return _connected.size(); }
     RoadMap::Node &RoadMap::Node::getConnected(size_t index) { return _parent->getNode(_connected[index]); }
+    const RoadMap::Node &RoadMap::Node::getConnected(size_t index) const { return _parent->getNode(_connected[index]); }
     RoadMap &RoadMap::Node::getRoadMap() { return *_parent; }
 
     size_t RoadMap::Node::addPose(float theta)
     {
         size_t id = _poses.size();
         _poses.push_back(Orientation(this, id, theta));
+        _parent->touch();
         return id;
     }
 
@@ -202,16 +987,41 @@ namespace rm
                 return false;
 
         _connected.push_back(to);
+        _parent->touch();
         return true;
     }
 
+    bool RoadMap::Node::isConnectedTo(node_id to) const
+    {
+        for (auto id : _connected)
+            if (id == to)
+                return true;
+        return false;
+    }
+
+    bool RoadMap::Node::disconnectFrom(node_id to)
+    {
+        for (auto it = _connected.begin(); it != _connected.end(); it++)
+        {
+            if (*it == to)
+            {
+                _connected.erase(it);
+                _parent->touch();
+                return true;
+            }
+        }
+        return false;
+    }
+
     RoadMap::Node::operator node_id() const
     {
         return _id;
     }
 
     // Node::Orientation
-    RoadMap::Node::Orientation::Orientation(Node *parent, size_t id, float theta) : _parent(parent), _id(id), _theta(theta) {}
+    RoadMap::Node::Orientation::Orientation(Node *parent, size_t id, float theta)
+        : _theta(theta), _parent(parent), _connections(ArenaAllocator<DubinsConnection>(parent->_parent->_arena.get())),
+          _from(ArenaAllocator<DubinsConnection>(parent->_parent->_arena.get())), _id(id) {}
 
     bool RoadMap::Node::Orientation::connect(Orientation &other, float const &kmax, const std::vector<Polygon> &obstacles, const Polygon &borders)
     {
@@ -224,33 +1034,52 @@ namespace rm
         end.y = other._parent->getY();
         end.theta = other._theta;
         dubins::findPaths(curves, start, end, kmax);
-        while (!curves.empty())
+        for (const auto &curve : curves)
         {
-            bool collision = borders.empty() ? false : collisionCheck(*curves.begin(), borders);
-            if (!collision)
-            {
-                for (const auto &obst : obstacles)
-                {
-                    if (collisionCheck(*curves.begin(), obst))
-                    {
-                        collision = true;
-                        break;
-                    }
-                }
-            }
-            if (collision)
-            {
-                curves.erase(curves.begin());
+            if (collisionCheck(curve, obstacles, borders))
                 continue;
-            }
-            
-            _connections.push_back(RoadMap::DubinsConnection(this, &other, *curves.begin()));
+
+            size_t id = _parent->getRoadMap().addConnectionState(VALID);
+            _connections.push_back(RoadMap::DubinsConnection(this, &other, curve, id));
             other._from.push_back(_connections.back());
             return true;
         }
         return false;
     }
 
+    bool RoadMap::Node::Orientation::connectUnchecked(Orientation &other, float const &kmax)
+    {
+        std::set<dubins::DubinsCurve> curves;
+        dubins::Pose2D start, end;
+        start.x = _parent->getX();
+        start.y = _parent->getY();
+        start.theta = _theta;
+        end.x = other._parent->getX();
+        end.y = other._parent->getY();
+        end.theta = other._theta;
+        dubins::findPaths(curves, start, end, kmax);
+        if (curves.empty())
+            return false;
+
+        size_t id = _parent->getRoadMap().addConnectionState(UNCHECKED);
+        _connections.push_back(RoadMap::DubinsConnection(this, &other, *curves.begin(), id));
+        other._from.push_back(_connections.back());
+        return true;
+    }
+
+    void RoadMap::Node::Orientation::addConnection(Orientation &other, const dubins::DubinsCurve &path)
+    {
+        size_t id = _parent->getRoadMap().addConnectionState(VALID);
+        _connections.push_back(RoadMap::DubinsConnection(this, &other, path, id));
+        other._from.push_back(_connections.back());
+    }
+
+    void RoadMap::Node::Orientation::reserve(size_t connections, size_t from)
+    {
+        _connections.reserve(connections);
+        _from.reserve(from);
+    }
+
     float RoadMap::Node::Orientation::getTheta() const { return _theta; }
     size_t RoadMap::Node::Orientation::getID() const { return _id; }
     RoadMap::Node &RoadMap::Node::Orientation::getNode() const { return *_parent; }
@@ -0,0 +1,189 @@
+#include "rm/tiled.hpp"
+
+#include "rm/geometry.hpp"
+#include "rm/visibility.hpp"
+#include "utils/parallel.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace rm
+{
+    namespace
+    {
+        struct Rect
+        {
+            float x0, y0, x1, y1;
+        };
+
+        Rect bounds(const Polygon &polygon)
+        {
+            Rect rect = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+            for (const auto &p : polygon)
+            {
+                rect.x0 = std::min(rect.x0, p.x);
+                rect.y0 = std::min(rect.y0, p.y);
+                rect.x1 = std::max(rect.x1, p.x);
+                rect.y1 = std::max(rect.y1, p.y);
+            }
+            return rect;
+        }
+
+        Rect expand(const Rect &rect, float d) { return Rect{rect.x0 - d, rect.y0 - d, rect.x1 + d, rect.y1 + d}; }
+
+        bool contains(const Rect &rect, const Point &p) { return p.x >= rect.x0 && p.x <= rect.x1 && p.y >= rect.y0 && p.y <= rect.y1; }
+
+        bool intersects(const Rect &a, const Rect &b) { return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1; }
+
+        /**
+         * @brief Select the polygons whose bounding box intersects a region.
+         */
+        std::vector<Polygon> localPolygons(const std::vector<Polygon> &polygons, const Rect &region)
+        {
+            std::vector<Polygon> out;
+            for (const auto &polygon : polygons)
+            {
+                if (intersects(bounds(polygon), region))
+                    out.push_back(polygon);
+            }
+            return out;
+        }
+    }
+
+    unsigned long buildTiled(RoadMap &roadmap, const std::vector<Polygon> &obstacles, const Polygon &borders, float offset, float threshold,
+                             const std::vector<Polygon> &infObstacles, const Polygon &infBorders,
+                             unsigned int orientationsPerNode, float kmax, unsigned int tiles, float overlap, unsigned int threads)
+    {
+        if (tiles == 0)
+            throw std::logic_error("TILED - INVALID NUMBER OF TILES");
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t n_tiles = tiles * tiles;
+
+        // Split the arena into a grid of tiles
+        const Rect arena = bounds(borders);
+        const float width = (arena.x1 - arena.x0) / tiles, height = (arena.y1 - arena.y0) / tiles;
+        auto tileOf = [&](const Point &p) {
+            size_t i = std::min<size_t>(tiles - 1, std::max(0.0f, (p.x - arena.x0) / width));
+            size_t j = std::min<size_t>(tiles - 1, std::max(0.0f, (p.y - arena.y0) / height));
+            return j * tiles + i;
+        };
+        std::vector<Rect> cores;
+        for (unsigned int j = 0; j < tiles; j++)
+        {
+            for (unsigned int i = 0; i < tiles; i++)
+                cores.push_back(Rect{arena.x0 + i * width, arena.y0 + j * height, arena.x0 + (i + 1) * width, arena.y0 + (j + 1) * height});
+        }
+
+        // Select the vertices of each tile from the obstacles around it.
+        // Inflated obstacles are merged when they overlap, so the ones within twice the offset are included.
+        std::vector<std::vector<Point>> tile_vertices(n_tiles);
+        utils::parallelFor(n_tiles, threads, [&](size_t t) {
+            std::vector<Point> candidates;
+            makeVisibilityNodes(localPolygons(obstacles, expand(cores[t], 2 * offset + threshold)), borders, offset, candidates, threshold);
+            for (const auto &p : candidates)
+            {
+                if (tileOf(p) == t)
+                    tile_vertices[t].push_back(p);
+            }
+        });
+        std::vector<Point> vertices;
+        std::vector<size_t> owner;
+        for (size_t t = 0; t < n_tiles; t++)
+        {
+            vertices.insert(vertices.end(), tile_vertices[t].begin(), tile_vertices[t].end());
+            owner.insert(owner.end(), tile_vertices[t].size(), t);
+        }
+        tile_vertices.clear();
+
+        // Build each tile, then move it into the roadmap
+        const RoadMap::node_id NONE = -1;
+        std::vector<RoadMap::node_id> global_id(vertices.size(), NONE);
+        std::mutex roadmap_mutex;
+        unsigned long n_connections = 0L;
+        utils::parallelFor(n_tiles, threads, [&](size_t t) {
+            const Rect region = expand(cores[t], overlap);
+            std::vector<size_t> members;
+            for (size_t v = 0; v < vertices.size(); v++)
+            {
+                if (contains(region, vertices[v]))
+                    members.push_back(v);
+            }
+            // Any of the Dubins paths tried by the build may be kept, CCC ones included. Their middle arc lies on a circle whose centre is
+            // at most three radii from an end point, so no path leaves the region by more than four radii
+            std::vector<Polygon> local_obstacles = localPolygons(infObstacles, expand(region, 4 / kmax));
+
+            // Visibility edges with a vertex of this tile. An edge to a vertex of another tile is computed by the tile with the lower index,
+            // unless the vertex of this tile is out of reach of the other one.
+            RoadMap tile;
+            std::vector<size_t> tile_vertex;
+            for (size_t a = 0; a < members.size(); a++)
+            {
+                for (size_t b = a + 1; b < members.size(); b++)
+                {
+                    size_t u = members[a], v = members[b];
+                    if (owner[u] != t && owner[v] != t)
+                        continue;
+                    size_t other = owner[u] == t ? owner[v] : owner[u];
+                    const Point &own = owner[u] == t ? vertices[u] : vertices[v];
+                    if (other < t && contains(expand(cores[other], overlap), own))
+                        continue;
+
+                    Segment s(vertices[u], vertices[v]);
+                    bool visible = !collisionCheck(s, infBorders);
+                    for (size_t i = 0; i < local_obstacles.size() && visible; i++)
+                    {
+                        const Polygon &obst = local_obstacles[i];
+                        visible = !collisionCheck(vertices[u], obst) && !collisionCheck(vertices[v], obst) && !collisionCheck(s, obst);
+                    }
+                    if (!visible)
+                        continue;
+
+                    RoadMap::node_id n0 = tile.addNode(vertices[u]);
+                    RoadMap::node_id n1 = tile.addNode(vertices[v]);
+                    tile_vertex.resize(tile.getNodeCount());
+                    tile_vertex[n0] = u;
+                    tile_vertex[n1] = v;
+                    tile.connect(n0, n1);
+                    tile.connect(n1, n0);
+                }
+            }
+            if (tile.getNodeCount() == 0)
+                return;
+            tile.build(orientationsPerNode, kmax, local_obstacles, infBorders);
+
+            std::lock_guard<std::mutex> lock(roadmap_mutex);
+            for (RoadMap::node_id id = 0; id < tile.getNodeCount(); id++)
+            {
+                size_t v = tile_vertex[id];
+                if (global_id[v] != NONE)
+                    continue;
+                global_id[v] = roadmap.addNode(vertices[v]);
+                const RoadMap::Node &node = tile.getNode(id);
+                for (size_t j = 0; j < node.getPosesCount(); j++)
+                    roadmap.getNode(global_id[v]).addPose(node.getPose(j).getTheta());
+            }
+            for (RoadMap::node_id id = 0; id < tile.getNodeCount(); id++)
+            {
+                const RoadMap::Node &node = tile.getNode(id);
+                RoadMap::Node &global = roadmap.getNode(global_id[tile_vertex[id]]);
+                for (size_t i = 0; i < node.getConnectedCount(); i++)
+                    global.connectTo(global_id[tile_vertex[node.getConnected(i).getID()]]);
+                for (size_t j = 0; j < node.getPosesCount(); j++)
+                {
+                    const RoadMap::Node::Orientation &pose = node.getPose(j);
+                    for (size_t c = 0; c < pose.getConnectionCount(); c++)
+                    {
+                        const RoadMap::DubinsConnection &connection = pose.getConnection(c);
+                        RoadMap::Node &to = roadmap.getNode(global_id[tile_vertex[connection.to->getNode().getID()]]);
+                        global.getPose(j).addConnection(to.getPose(connection.to->getID()), connection.path);
+                        n_connections++;
+                    }
+                }
+            }
+        });
+        return n_connections;
+    }
+}
@@ -12,7 +12,13 @@
 #include "rm/roadmap.hpp"
 #include "rm/visibility.hpp"
 #include "rm/inflate.hpp"
+#include "rm/cache.hpp"
+#include "rm/overlay.hpp"
+#include "rm/tiled.hpp"
+#include "rm/lattice.hpp"
 #include "nav/navmap.hpp"
+#include "nav/gatemap.hpp"
+#include "nav/table.hpp"
 #include "nav/pursuerevader.hpp"
 #include "nav/path.hpp"
 #include "dubins/dubins.hpp"
@@ -78,9 +84,23 @@ namespace student
 		const float visibility_offset = collision_offset * 1.3f; // Offset for visibility graph vertices
 		const float visibility_threshold = robot_size * 0.5f;	 // Minimum distance between consecutive nodes
 		const int n_poses = 8;									 // Number of poses per node
+		const int min_poses = 0;								 // Minimum number of poses per node chosen from the local geometry (0: n_poses on every node)
+		const bool lazy_roadmap = false;							 // Whether collision checking is deferred to query time
+		const bool prune_roadmap = false;						 // Whether connections never needed by a shortest path are removed after the build
+		const int roadmap_tiles = 1;							 // Number of tiles along each side of the arena built in parallel (1: single roadmap)
+		const float tile_overlap = 0.4f;						 // Distance within which vertices of neighbouring tiles are connected
+		const bool state_lattice = false;						 // Whether the roadmap is a state lattice of motion primitives instead of a visibility graph
+		const float lattice_spacing = robot_size * 0.5f;		 // Distance between neighbouring positions of the state lattice
+		const int lattice_reach = 3;							 // Maximum length of the motion primitives, in lattice steps
+		const bool enable_roadmap_cache = true;					 // Whether built roadmaps are cached in config_folder
+		const float cache_resolution = 0.005f;					 // Grid obstacles are snapped to before looking for a cached roadmap, well below collision_offset
+		const int cache_files = 8;								 // Maximum number of roadmaps kept in config_folder
 		const float kmax = 1 / robot_size;						 // Maximum curvature of Dubins paths
-		const int k = 10; 										 // Robot free roaming parameter
+		const int k = state_lattice ? 40 : 10;					 // Robot free roaming parameter, larger on lattices whose nodes are closer than a turning radius
 		const float step = M_PI / 32 / kmax;					 // Discretization step
+		const float region_size = 0.0f;							 // Side of the regions restricting the searches of the pursuer (0: full searches)
+		const bool distance_table = false;						 // Whether shortest paths between all poses are pre-computed, so that the pursuer plans without searching
+		const bool refine_paths = false;						 // Whether headings along the paths are optimized after the game, which makes them shorter than the ones it was played on
 		const bool enable_matlab_output = true; 				 // Whether to generate matlab file for plotting
 		const std::string matlab_file = config_folder + "/student_interface_plot.m";
 
@@ -108,76 +128,162 @@ namespace student
 			auto infBorders = rm::inflate(std::vector<Polygon>{borders}, -collision_offset, false).back();
 			t.toc();
 
-			// Select vertices
-			t.tic("Selecting vertices for graph...");
-			std::vector<Point> vertices;
-			rm::makeVisibilityNodes(obstacle_list, borders, visibility_offset, vertices, visibility_threshold);
-			t.toc();
-
-			// Setup RoadMap by visibility graph
-			t.tic("Computing visibility graph...");
+			// Look for a roadmap built on the same arena
 			rm::RoadMap rm;
-			rm::visibility(rm, vertices, infObstacles, infBorders);
-			t.toc();
+			const bool use_cache = enable_roadmap_cache && !lazy_roadmap;
+			const uint64_t rm_key = rm::hashArena(borders, obstacle_list, n_poses, kmax,
+												  {collision_offset, visibility_offset, visibility_threshold, float(min_poses), float(prune_roadmap), float(roadmap_tiles), tile_overlap,
+												   float(state_lattice), lattice_spacing, float(lattice_reach)},
+												  cache_resolution);
+			const std::string rm_file = rm::getCacheFile(config_folder, rm_key);
+			bool cached = false;
+			if (use_cache)
+			{
+				t.tic("Loading cached roadmap...");
+				cached = rm::loadRoadMap(rm, rm_file, rm_key);
+				t.toc(cached ? "DONE" : "NOT FOUND");
+			}
 
-			// Build RoadMap
-			t.tic("Building roadmap (may require a few seconds)...");
-			rm.build(n_poses, kmax, infObstacles, infBorders);
-			t.toc();
+			if (!cached)
+			{
+				if (state_lattice)
+				{
+					// Build RoadMap by footprint lookups of precomputed motion primitives
+					t.tic("Computing motion primitives...");
+					rm::MotionPrimitives primitives(lattice_spacing, n_poses, lattice_reach, kmax, 4, 2 / kmax);
+					t.toc(std::to_string(primitives.getPrimitiveCount()) + " primitives");
+
+					t.tic("Building state lattice...");
+					rm::buildLattice(rm, primitives, infObstacles, infBorders);
+					t.toc();
+				}
+				else if (roadmap_tiles > 1)
+				{
+					// Build RoadMap by tiles, each one selecting its vertices and computing its visibility graph
+					t.tic("Building tiled roadmap...");
+					rm::buildTiled(rm, obstacle_list, borders, visibility_offset, visibility_threshold, infObstacles, infBorders,
+								   n_poses, kmax, roadmap_tiles, tile_overlap);
+					t.toc();
+				}
+				else
+				{
+					// Select vertices
+					t.tic("Selecting vertices for graph...");
+					std::vector<Point> vertices;
+					rm::makeVisibilityNodes(obstacle_list, borders, visibility_offset, vertices, visibility_threshold);
+					t.toc();
+
+					// Setup RoadMap by visibility graph
+					t.tic("Computing visibility graph...");
+					rm::visibility(rm, vertices, infObstacles, infBorders);
+					t.toc();
+
+					// Build RoadMap
+					t.tic(lazy_roadmap ? "Building lazy roadmap..." : "Building roadmap (may require a few seconds)...");
+					if (min_poses > 0)
+						rm.buildAdaptive(min_poses, n_poses, kmax, infObstacles, infBorders, lazy_roadmap);
+					else
+						rm.build(n_poses, kmax, infObstacles, infBorders, lazy_roadmap);
+					t.toc();
+				}
+
+				// Remove dominated connections
+				if (prune_roadmap)
+				{
+					t.tic("Pruning roadmap...");
+					unsigned long pruned = rm.prune();
+					t.toc(std::to_string(pruned) + " connections removed");
+				}
+
+				// Store RoadMap for the next runs
+				if (use_cache)
+				{
+					t.tic("Storing roadmap to cache...");
+					t.toc(rm::saveRoadMap(rm, rm_file, rm_key) ? "DONE" : "FAILED");
+					rm::pruneCache(config_folder, cache_files);
+				}
+			}
+
+			// Start and goal poses are added to a query overlay, the roadmap itself is left untouched
+			auto overlay = std::make_shared<rm::Overlay>(rm.freeze());
 
 			// Add initial positions
 			t.tic("Adding start poses...");
 			t.tic();
-			auto &source_e = rm.addStartPose(Point(x[0], y[0]), theta[0], k, kmax, infObstacles, infBorders);
+			auto source_e = overlay->addStartPose(Point(x[0], y[0]), theta[0], k, kmax, infObstacles, infBorders);
 			t.toc("Evader");
 
 			t.tic();
-			auto &source_p = rm.addStartPose(Point(x[1], y[1]), theta[1], k, kmax, infObstacles, infBorders);
+			auto source_p = overlay->addStartPose(Point(x[1], y[1]), theta[1], k, kmax, infObstacles, infBorders);
 			t.toc("Pursuer");
 			t.toc();
 
 			// Add gate positions
 			t.tic("Adding goal poses...");
-			std::vector<rm::RoadMap::Node::Orientation *> goal;
+			std::vector<rm::Overlay::pose_id> goal;
 			for (size_t i = 0; i < gate_list.size(); i++)
 			{
 				t.tic();
 				float gate_x, gate_y, gate_th;
 				rm::getGatePose(gate_list[i], borders, gate_x, gate_y, gate_th);
-				goal.push_back(&rm.addGoalPose(Point(gate_x, gate_y), gate_th, k, kmax, infObstacles, borders));
+				goal.push_back(overlay->addGoalPose(Point(gate_x, gate_y), gate_th, k, kmax, infObstacles, borders));
 				t.toc(std::to_string(i + 1) + "/" + std::to_string(gate_list.size()));
 			}
 			t.toc();
 
 			// Precompute navigation weights
 			t.tic("Precomputing navigation maps for evader (Dijkstra algorithm)...");
-			std::vector<nav::NavMap> nm_e;
-			for (size_t i = 0; i < goal.size(); i++)
-			{
-				t.tic();
-				nm_e.push_back(nav::NavMap(rm));
-				nm_e.back().computeReverse(*goal[i]);
-				t.toc(std::to_string(i + 1) + "/" + std::to_string(goal.size()));
-			}
+			nav::GateMap gates(overlay);
+			gates.compute(goal);
 			t.toc();
 
 			// Run game
 			t.tic("Running game...");
-			nav::navList nav_list_e, nav_list_p;
-			nav::NavMap nm_p(rm);
-			nav::runGame(nm_e, nm_p, source_e, source_p, nav_list_e, nav_list_p);
+			nav::edgeList nav_list_e, nav_list_p;
+			nav::NavMap nm_p(overlay);
+			std::unique_ptr<nav::Hierarchy> hierarchy;
+			if (region_size > 0.0f)
+				hierarchy.reset(new nav::Hierarchy(rm.freeze(), region_size));
+			std::unique_ptr<nav::DistanceTable> table;
+			if (distance_table)
+			{
+				t.tic("Precomputing distance table...");
+				table.reset(new nav::DistanceTable(rm.freeze()));
+				t.toc();
+			}
+			nav::Replanner replanner(nm_p, *overlay, hierarchy.get());
+			nav::runGame(gates, replanner, *overlay, source_e, source_p, nav_list_e, nav_list_p, table.get());
 			t.toc();
 
+			// Work saved by the pursuer, against a full search from its start pose at every step
+			if (table == nullptr)
+			{
+				t.tic("Comparing pursuer replanning with full searches...");
+				nm_p.compute(source_p);
+				t.toc(std::to_string(replanner.getSearchCount()) + " searches in " + std::to_string(replanner.getStepCount()) + " steps, " +
+					  std::to_string(replanner.getExpandedCount()) + " poses expanded instead of about " +
+					  std::to_string(replanner.getStepCount() * nm_p.getExpandedCount()));
+			}
+
+			// Refine headings along the paths
+			if (refine_paths)
+			{
+				t.tic("Refining paths...");
+				nav_list_e = nav::refinePath(*overlay, nav_list_e, kmax, infObstacles, infBorders);
+				nav_list_p = nav::refinePath(*overlay, nav_list_p, kmax, infObstacles, infBorders);
+				t.toc();
+			}
+
 			// Discretize paths
 			t.tic("Discretizing paths...");
 			t.tic();
 			std::vector<Pose> discr_path_e;
-			nav::discretizePath(nav_list_e, step, discr_path_e);
+			nav::discretizePath(*overlay, nav_list_e, step, discr_path_e);
 			t.toc("Evader path");
 
 			t.tic();
 			std::vector<Pose> discr_path_p;
-			nav::discretizePath(nav_list_p, step, discr_path_p);
+			nav::discretizePath(*overlay, nav_list_p, step, discr_path_p);
 			t.toc("Pursuer path");
 			t.toc();
 
@@ -35,7 +35,7 @@ namespace utils
         _file << "\% Nodes" << std::endl;
         for (size_t i = 0; i < rm.getNodeCount(); i++)
 		{
-            auto node = rm.getNode(i);
+            const auto &node = rm.getNode(i);
 			plotPoint(Point(node.getX(), node.getY()), style);
 		}
         _file << std::endl;
@@ -46,10 +46,10 @@ namespace utils
         _file << "\% Edges" << std::endl;
         for (size_t i = 0; i < rm.getNodeCount(); i++)
 		{
-			auto node = rm.getNode(i);
+			const auto &node = rm.getNode(i);
 			for (size_t j = 0; j < node.getConnectedCount(); j++)
 			{
-				auto other = node.getConnected(j);
+				const auto &other = node.getConnected(j);
                 plotSegment(rm::Segment(node.getX(), node.getY(), other.getX(), other.getY()), style);
 			}
 		}